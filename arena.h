@@ -13,6 +13,7 @@
     #define ARENA_TARGET_WASM 0
 
     #include <stddef.h>
+    #include <stdbool.h>
     #ifndef ARENA_ASSERT
         #include <assert.h>
         #define ARENA_ASSERT(X) assert((X))
@@ -25,6 +26,10 @@
 #endif
 
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct Region Region;
 struct Region {
     Region* next;
@@ -37,12 +42,35 @@ struct Region {
 Region* region_init(size_t capacity);
 void region_deinit(Region* r);
 
+typedef struct Arena_Finalizer Arena_Finalizer;
+struct Arena_Finalizer {
+    Arena_Finalizer* next;
+    void (*fn)(void* data);
+    void* data;
+};
+
 typedef struct {
     Region* first;
     Region* last;
+    Arena_Finalizer* finalizers;
+    void* image;        // mapping made by arena_restore(), released by arena_free()
+    size_t image_size;
 } Arena;
 
 void* arena_alloc(Arena* a, size_t size);
+
+/**
+ * `arena_alloc()` with the result aligned to `alignment` (a power of two).
+ * `arena_alloc()` itself never pads.
+ */
+void* arena_alloc_aligned(Arena* a, size_t size, size_t alignment);
+
+/**
+ * Registers `fn(data)` to run on the next `arena_reset()` or `arena_free()`,
+ * most recently registered first. The list node lives in the arena.
+ */
+void arena_on_reset(Arena* a, void (*fn)(void* data), void* data);
+
 void* arena_realloc(Arena* a, void* oldptr, size_t old_size, size_t new_size);
 void arena_reset(Arena* a);
 void arena_free(Arena* a);
@@ -50,40 +78,310 @@ void arena_free(Arena* a);
 char* arena_load_file_text(Arena* a, const char* file_path);
 unsigned char* arena_load_file_data(Arena* a, const char* file_path);
 
+/**
+ * Makes sure the next `capacity` bytes of allocations land in one region
+ */
+void arena_reserve(Arena* a, size_t capacity);
+
+#if !ARENA_TARGET_WASM
+
+/**
+ * Arena images for fast startup
+ *
+ * `arena_snapshot()` writes the used part of every region into one file,
+ * keeping each region's address modulo 64 so alignment survives.
+ * `arena_restore()` maps that file copy-on-write into an empty arena, whose
+ * regions then point into the mapping, and returns the start of the first
+ * region: the first allocation made with an alignment of at most 16.
+ *
+ * Raw pointers into the arena are meaningless after a restore, store `Rel_Ptr`s
+ * instead. They are relative to their own address, so they only survive when
+ * both ends are in the same region: build the data after `arena_reserve()`.
+ * Images are only portable between builds with the same struct layouts.
+ */
+bool arena_snapshot(const Arena* a, const char* path);
+void* arena_restore(Arena* a, const char* path);
+
+#endif // !ARENA_TARGET_WASM
+
+// Self-relative pointer, 0 is NULL so it can't point at itself
+typedef struct {
+    ptrdiff_t offset;
+} Rel_Ptr;
+
+static inline void rel_ptr_set(Rel_Ptr* p, const void* target)
+{
+    p->offset = target == NULL ? 0 : (const char*)target - (const char*)p;
+}
+
+static inline void* rel_ptr_get(const Rel_Ptr* p)
+{
+    return p->offset == 0 ? NULL : (char*)p + p->offset;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ARENA_H
 
 #ifdef ARENA_IMPLEMENTATION
 
+static size_t arena__padding(const Region* r, size_t alignment)
+{
+    size_t address = (size_t)r->data + r->usage;
+    return (alignment - (address & (alignment - 1))) & (alignment - 1);
+}
+
+static int arena__fits(const Region* r, size_t size, size_t alignment)
+{
+    return r->usage + arena__padding(r, alignment) + size <= r->capacity;
+}
+
 void* arena_alloc(Arena* a, size_t size)
 {
+    return arena_alloc_aligned(a, size, 1);
+}
+
+void* arena_alloc_aligned(Arena* a, size_t size, size_t alignment)
+{
+    ARENA_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    // Enough room for the worst padding, whatever address the region starts at
+    size_t capacity = REGION_DEFAULT_CAPACITY;
+    if(capacity < size + alignment - 1) capacity = size + alignment - 1;
+
     if(a->last == NULL) {
         ARENA_ASSERT(a->first == NULL);
-        size_t capacity = REGION_DEFAULT_CAPACITY;
-        if(capacity < size) capacity = size;
         a->last = region_init(capacity);
         a->first = a->last;
     }
 
-    while(a->last->usage + size > a->last->capacity && a->last->next != NULL)
+    while(!arena__fits(a->last, size, alignment) && a->last->next != NULL)
     {
         a->last = a->last->next;
     }
 
-    if(a->last->usage + size > a->last->capacity) {
+    if(!arena__fits(a->last, size, alignment)) {
         ARENA_ASSERT(a->last->next == NULL);
-        size_t capacity = REGION_DEFAULT_CAPACITY;
-        if(capacity < size) capacity = size;
+        a->last->next = region_init(capacity);
+        a->last = a->last->next;
+    }
+
+    size_t padding = arena__padding(a->last, alignment);
+    void* result = (void*)((size_t)a->last->data + a->last->usage + padding);
+    a->last->usage += padding + size;
+    return result;
+}
+
+void arena_on_reset(Arena* a, void (*fn)(void* data), void* data)
+{
+    Arena_Finalizer* f = (Arena_Finalizer*)arena_alloc_aligned(a, sizeof(Arena_Finalizer), sizeof(void*));
+    f->fn = fn;
+    f->data = data;
+    f->next = a->finalizers;
+    a->finalizers = f;
+}
+
+static void arena__run_finalizers(Arena* a)
+{
+    Arena_Finalizer* f = a->finalizers;
+    a->finalizers = NULL;
+    for(; f != NULL; f = f->next) f->fn(f->data);
+}
+
+void arena_reserve(Arena* a, size_t capacity)
+{
+    if(a->last == NULL) {
+        ARENA_ASSERT(a->first == NULL);
         a->last = region_init(capacity);
         a->first = a->last;
+        return;
     }
+    if(a->last->usage + capacity <= a->last->capacity) return;
+    // A new region right after `last`, the rest of the chain follows it
+    Region* r = region_init(capacity);
+    r->next = a->last->next;
+    a->last->next = r;
+    a->last = r;
+}
 
-    void* result = (void*)((size_t)a->last->data + a->last->usage);
-    a->last->usage += size;
-    return result;
+#if !ARENA_TARGET_WASM
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define ARENA__MMAP 1
+#else
+    #define ARENA__MMAP 0
+#endif
+
+#define ARENA__IMAGE_MAGIC "ARENAIMG"
+#define ARENA__IMAGE_VERSION 1
+#define ARENA__IMAGE_ALIGNMENT 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t region_count;
+    uint64_t size;
+} Arena__Image_Header;
+
+typedef struct {
+    uint64_t offset, usage;
+} Arena__Image_Region;
+
+// Where the data of a region goes, congruent to its address modulo 64
+static uint64_t arena__image_offset(uint64_t cursor, const Region* r)
+{
+    uint64_t want = (uint64_t)(uintptr_t)r->data % ARENA__IMAGE_ALIGNMENT;
+    return cursor + ((want - cursor % ARENA__IMAGE_ALIGNMENT) + ARENA__IMAGE_ALIGNMENT) % ARENA__IMAGE_ALIGNMENT;
+}
+
+bool arena_snapshot(const Arena* a, const char* path)
+{
+    Arena__Image_Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARENA__IMAGE_MAGIC, sizeof(header.magic));
+    header.version = ARENA__IMAGE_VERSION;
+    for(const Region* r = a->first; r != NULL; r = r->next) {
+        if(r->usage > 0) header.region_count += 1;
+    }
+    uint64_t data_start = sizeof(header) + header.region_count * sizeof(Arena__Image_Region);
+    uint64_t cursor = data_start;
+    for(const Region* r = a->first; r != NULL; r = r->next) {
+        if(r->usage > 0) cursor = arena__image_offset(cursor, r) + r->usage;
+    }
+    header.size = cursor;
+
+    FILE* f = fopen(path, "wb");
+    if(f == NULL) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    cursor = data_start;
+    for(const Region* r = a->first; ok && r != NULL; r = r->next) {
+        if(r->usage == 0) continue;
+        Arena__Image_Region entry;
+        entry.offset = arena__image_offset(cursor, r);
+        entry.usage = r->usage;
+        ok = fwrite(&entry, sizeof(entry), 1, f) == 1;
+        cursor = entry.offset + entry.usage;
+    }
+    static const char zeros[ARENA__IMAGE_ALIGNMENT] = {0};
+    cursor = data_start;
+    for(const Region* r = a->first; ok && r != NULL; r = r->next) {
+        if(r->usage == 0) continue;
+        uint64_t offset = arena__image_offset(cursor, r);
+        if(offset > cursor) ok = fwrite(zeros, (size_t)(offset - cursor), 1, f) == 1;
+        if(ok) ok = fwrite(r->data, r->usage, 1, f) == 1;
+        cursor = offset + r->usage;
+    }
+    if(fclose(f) != 0) ok = false;
+    return ok;
+}
+
+static void* arena__map_image(const char* path, size_t* size)
+{
+#if ARENA__MMAP
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+    struct stat st;
+    void* image = NULL;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        // Private and writable: pages are shared with the page cache until written
+        image = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if(image == MAP_FAILED) image = NULL;
+        *size = (size_t)st.st_size;
+    }
+    close(fd);
+    return image;
+#else
+    FILE* f = fopen(path, "rb");
+    if(f == NULL) return NULL;
+    void* image = NULL;
+    if(fseek(f, 0, SEEK_END) == 0) {
+        long length = ftell(f);
+        if(length > 0 && fseek(f, 0, SEEK_SET) == 0) {
+            image = malloc((size_t)length);
+            if(image != NULL && fread(image, (size_t)length, 1, f) != 1) {
+                free(image);
+                image = NULL;
+            }
+            *size = (size_t)length;
+        }
+    }
+    fclose(f);
+    return image;
+#endif
 }
 
+static void arena__unmap_image(void* image, size_t size)
+{
+#if ARENA__MMAP
+    munmap(image, size);
+#else
+    (void)size;
+    free(image);
+#endif
+}
+
+void* arena_restore(Arena* a, const char* path)
+{
+    ARENA_ASSERT(a->first == NULL && a->image == NULL);
+    size_t size = 0;
+    unsigned char* image = (unsigned char*)arena__map_image(path, &size);
+    if(image == NULL) return NULL;
+
+    Arena__Image_Header header;
+    bool ok = size >= sizeof(header);
+    if(ok) {
+        memcpy(&header, image, sizeof(header));
+        ok = memcmp(header.magic, ARENA__IMAGE_MAGIC, sizeof(header.magic)) == 0
+            && header.version == ARENA__IMAGE_VERSION && header.size == size && header.region_count > 0
+            && sizeof(header) + header.region_count * sizeof(Arena__Image_Region) <= size;
+    }
+    for(uint32_t i = 0; ok && i < header.region_count; ++i) {
+        Arena__Image_Region entry;
+        memcpy(&entry, image + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        ok = entry.offset <= size && entry.usage <= size - entry.offset;
+        if(!ok) break;
+
+        // Full regions that point into the image, so new allocations go to new regions
+        Region* r = (Region*)malloc(sizeof(Region));
+        ARENA_ASSERT(r != NULL);
+        r->next = NULL;
+        r->usage = (size_t)entry.usage;
+        r->capacity = (size_t)entry.usage;
+        r->data = image + entry.offset;
+        if(a->last == NULL) a->first = r;
+        else a->last->next = r;
+        a->last = r;
+    }
+    if(!ok) {
+        for(Region* r = a->first; r != NULL;) {
+            Region* next = r->next;
+            free(r);
+            r = next;
+        }
+        a->first = a->last = NULL;
+        arena__unmap_image(image, size);
+        return NULL;
+    }
+    a->image = image;
+    a->image_size = size;
+    return a->first->data;
+}
+
+#endif // !ARENA_TARGET_WASM
+
 void arena_reset(Arena* a)
 {
+    arena__run_finalizers(a);
     for(Region* r = a->first; r != NULL; r = r->next) {
         r->usage = 0;
     }
@@ -92,6 +390,7 @@ void arena_reset(Arena* a)
 
 void arena_free(Arena* a)
 {
+    arena__run_finalizers(a);
     Region* r = a->first;
     while(r) {
         Region* current = r;
@@ -100,6 +399,11 @@ void arena_free(Arena* a)
     }
     a->first = NULL;
     a->last = NULL;
+#if !ARENA_TARGET_WASM
+    if(a->image != NULL) arena__unmap_image(a->image, a->image_size);
+    a->image = NULL;
+    a->image_size = 0;
+#endif
 }
 
 
@@ -115,7 +419,7 @@ Region* region_init(size_t capacity)
     r->next = NULL;
     r->usage = 0;
     r->capacity = capacity;
-    r->data = (void*)(&r->data + sizeof(r->data));
+    r->data = (void*)(r + 1);
     return r;
 }
 
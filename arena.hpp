@@ -0,0 +1,100 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+/**
+ * C++ adapters for `arena.h`
+ *
+ * - `Arena_Resource` is a `std::pmr::memory_resource` over an `Arena`, so
+ *   `std::pmr` containers allocate with `arena_alloc_aligned()`. Deallocation
+ *   does nothing, memory comes back on `arena_reset()`/`arena_free()`.
+ * - `Arena_Allocator<T>` is the same as a plain standard allocator, for
+ *   containers that take an allocator type instead of a resource.
+ * - `arena_new<T>()` constructs a `T` in the arena and, when `T` has a
+ *   destructor, registers it with `arena_on_reset()`.
+ * - `arena_make_unique<T>()` constructs a `T` in the arena owned by an
+ *   `arena_unique_ptr<T>`, which only runs the destructor.
+ *
+ * Nothing here owns the arena, it has to outlive every container using it.
+ */
+
+#include "arena.h"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class Arena_Resource : public std::pmr::memory_resource {
+public:
+    explicit Arena_Resource(Arena* arena) : arena(arena) {}
+    Arena* get() const { return arena; }
+
+private:
+    Arena* arena;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return arena_alloc_aligned(arena, bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        const Arena_Resource* o = dynamic_cast<const Arena_Resource*>(&other);
+        return o != nullptr && o->arena == arena;
+    }
+};
+
+template<class T>
+struct Arena_Allocator {
+    using value_type = T;
+    Arena* arena;
+
+    explicit Arena_Allocator(Arena* arena) noexcept : arena(arena) {}
+    template<class U>
+    Arena_Allocator(const Arena_Allocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(std::size_t n)
+    {
+        if(n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(arena_alloc_aligned(arena, n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {}
+};
+
+template<class T, class U>
+bool operator==(const Arena_Allocator<T>& a, const Arena_Allocator<U>& b) { return a.arena == b.arena; }
+template<class T, class U>
+bool operator!=(const Arena_Allocator<T>& a, const Arena_Allocator<U>& b) { return a.arena != b.arena; }
+
+template<class T, class... Args>
+T* arena_new(Arena* arena, Args&&... args)
+{
+    void* memory = arena_alloc_aligned(arena, sizeof(T), alignof(T));
+    T* object = ::new(memory) T(std::forward<Args>(args)...);
+    if constexpr(!std::is_trivially_destructible_v<T>) {
+        arena_on_reset(arena, [](void* data) { static_cast<T*>(data)->~T(); }, object);
+    }
+    return object;
+}
+
+struct Arena_Destroy {
+    template<class T>
+    void operator()(T* object) const noexcept { object->~T(); }
+};
+
+template<class T>
+using arena_unique_ptr = std::unique_ptr<T, Arena_Destroy>;
+
+template<class T, class... Args>
+arena_unique_ptr<T> arena_make_unique(Arena* arena, Args&&... args)
+{
+    void* memory = arena_alloc_aligned(arena, sizeof(T), alignof(T));
+    return arena_unique_ptr<T>(::new(memory) T(std::forward<Args>(args)...));
+}
+
+#endif // ARENA_HPP
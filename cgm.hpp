@@ -0,0 +1,485 @@
+#ifndef CGM_HPP
+#define CGM_HPP
+
+/**
+ * C++ facade over `cgm.h`
+ *
+ * `cgm::vec2`, `cgm::vec3`, `cgm::vec4` and `cgm::mat4` have the exact layout
+ * of `V2f`, `V3f`, `V4f` and `M4f`, so arrays of them can go straight to the C
+ * batch functions through `as_c()`, and `from_c()`/`to_c()` convert single
+ * values. Everything here is `constexpr` (C++17), constant matrices such as
+ * `mat4::perspective()` fold at compile time.
+ *
+ * Vector arithmetic builds expression templates evaluated element by element
+ * when assigned to a vector, so `a*b + c*d` is one pass without temporaries and
+ * every `x*y + z` becomes an FMA when the target has one (`FP_FAST_FMAF`).
+ * Expressions keep references to their vector operands: assign them to a
+ * vector, do not keep them around in an `auto`.
+ *
+ * Matrices follow cgm: row vectors, `v * m`, and `a * b` applies `a` first.
+ */
+
+#if defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic" // anonymous structs in the C unions
+#endif
+#include "cgm.h"
+#if defined(__GNUC__)
+    #pragma GCC diagnostic pop
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_lib_is_constant_evaluated)
+    #define CGM_HPP_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__)
+    #define CGM_HPP_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+    // Never take the runtime-only paths, the constexpr ones are just slower
+    #define CGM_HPP_CONSTANT_EVALUATED() true
+#endif
+
+namespace cgm {
+
+namespace detail {
+
+constexpr float fmadd(float a, float b, float c)
+{
+    if(CGM_HPP_CONSTANT_EVALUATED()) return a * b + c;
+#if defined(FP_FAST_FMAF)
+    return std::fma(a, b, c);
+#else
+    return a * b + c;
+#endif
+}
+
+constexpr float sqrt(float x)
+{
+    if(!CGM_HPP_CONSTANT_EVALUATED()) return std::sqrt(x);
+    if(!(x > 0.0f)) return x == 0.0f ? 0.0f : NAN;
+    double y = x >= 1.0f ? x : 1.0;
+    for(int i = 0; i < 64; ++i) {
+        double next = 0.5 * (y + x / y);
+        if(next == y) break;
+        y = next;
+    }
+    return (float)y;
+}
+
+// Quadrant reduction and Taylor series in double, well below float precision
+constexpr void sincos(float angle, float* s, float* c)
+{
+    if(!CGM_HPP_CONSTANT_EVALUATED()) {
+        *s = std::sin(angle);
+        *c = std::cos(angle);
+        return;
+    }
+    constexpr double half_pi = 1.57079632679489661923;
+    double q = angle / half_pi;
+    long long k = (long long)(q >= 0.0 ? q + 0.5 : q - 0.5);
+    double r = angle - (double)k * half_pi;
+    double r2 = r * r;
+    double sr = 0.0, cr = 0.0, term_s = r, term_c = 1.0;
+    for(int n = 1; n <= 10; ++n) {
+        sr += term_s;
+        cr += term_c;
+        term_s *= -r2 / ((2.0*n) * (2.0*n + 1.0));
+        term_c *= -r2 / ((2.0*n - 1.0) * (2.0*n));
+    }
+    switch(((k % 4) + 4) % 4) {
+        case 0: *s = (float)sr;  *c = (float)cr;  break;
+        case 1: *s = (float)cr;  *c = (float)-sr; break;
+        case 2: *s = (float)-sr; *c = (float)-cr; break;
+        default: *s = (float)-cr; *c = (float)sr; break;
+    }
+}
+
+// Expression nodes, `size` is 0 for scalars so they adapt to the other side
+struct expr_tag {};
+
+template<class T>
+constexpr bool is_expr_v = std::is_base_of_v<expr_tag, std::decay_t<T>>;
+
+template<class T>
+constexpr bool is_operand_v = is_expr_v<T> || std::is_arithmetic_v<std::decay_t<T>>;
+
+struct scalar : expr_tag {
+    static constexpr bool is_vector = false;
+    static constexpr std::size_t size = 0;
+    float s;
+    constexpr explicit scalar(float s) : s(s) {}
+    constexpr float operator[](std::size_t) const { return s; }
+};
+
+// Vectors and nodes pass through by reference, numbers become scalars
+template<class T>
+constexpr decltype(auto) wrap(const T& t)
+{
+    if constexpr(is_expr_v<T>) return (t);
+    else return scalar((float)t);
+}
+
+template<class T>
+using wrapped_t = std::decay_t<decltype(wrap(std::declval<const T&>()))>;
+
+// Vectors are held by reference, intermediate nodes by value
+template<class T>
+using stored_t = std::conditional_t<T::is_vector, const T&, T>;
+
+struct add { static constexpr float apply(float a, float b) { return a + b; } };
+struct sub { static constexpr float apply(float a, float b) { return a - b; } };
+struct mul { static constexpr float apply(float a, float b) { return a * b; } };
+struct div { static constexpr float apply(float a, float b) { return a / b; } };
+
+template<class Op, class L, class R>
+struct binary : expr_tag {
+    static constexpr bool is_vector = false;
+    static constexpr std::size_t size = L::size > R::size ? L::size : R::size;
+    static_assert(L::size == 0 || R::size == 0 || L::size == R::size, "cgm: mixing vectors of different sizes");
+    using op = Op;
+    using left_type = L;
+    using right_type = R;
+    stored_t<L> l;
+    stored_t<R> r;
+    constexpr binary(const L& l, const R& r) : l(l), r(r) {}
+
+    constexpr float operator[](std::size_t i) const
+    {
+        // a*b + c and c + a*b fuse into one multiply-add
+        if constexpr(std::is_same_v<Op, add> && is_mul<L>()) return fmadd(l.l[i], l.r[i], r[i]);
+        else if constexpr(std::is_same_v<Op, add> && is_mul<R>()) return fmadd(r.l[i], r.r[i], l[i]);
+        else return Op::apply(l[i], r[i]);
+    }
+
+    template<class T>
+    static constexpr bool is_mul()
+    {
+        if constexpr(T::is_vector || std::is_same_v<T, scalar>) return false;
+        else return std::is_same_v<typename T::op, mul>;
+    }
+};
+
+template<class E>
+struct negate : expr_tag {
+    static constexpr bool is_vector = false;
+    static constexpr std::size_t size = E::size;
+    using op = void;
+    stored_t<E> e;
+    constexpr explicit negate(const E& e) : e(e) {}
+    constexpr float operator[](std::size_t i) const { return -e[i]; }
+};
+
+} // namespace detail
+
+template<class D, std::size_t N>
+struct vec_ops : detail::expr_tag {
+    static constexpr bool is_vector = true;
+    static constexpr std::size_t size = N;
+
+    constexpr D& self() { return static_cast<D&>(*this); }
+
+    template<class E, class = std::enable_if_t<detail::is_operand_v<E>>>
+    constexpr D& operator+=(const E& e) { return assign(detail::binary<detail::add, D, detail::wrapped_t<E>>(self(), detail::wrap(e))); }
+    template<class E, class = std::enable_if_t<detail::is_operand_v<E>>>
+    constexpr D& operator-=(const E& e) { return assign(detail::binary<detail::sub, D, detail::wrapped_t<E>>(self(), detail::wrap(e))); }
+    template<class E, class = std::enable_if_t<detail::is_operand_v<E>>>
+    constexpr D& operator*=(const E& e) { return assign(detail::binary<detail::mul, D, detail::wrapped_t<E>>(self(), detail::wrap(e))); }
+    template<class E, class = std::enable_if_t<detail::is_operand_v<E>>>
+    constexpr D& operator/=(const E& e) { return assign(detail::binary<detail::div, D, detail::wrapped_t<E>>(self(), detail::wrap(e))); }
+
+private:
+    // Element i only reads element i, so evaluating in place is safe
+    template<class E>
+    constexpr D& assign(const E& e)
+    {
+        for(std::size_t i = 0; i < N; ++i) self()[i] = e[i];
+        return self();
+    }
+};
+
+template<std::size_t N> struct vec;
+
+template<>
+struct vec<2> : vec_ops<vec<2>, 2> {
+    float x = 0.0f, y = 0.0f;
+    constexpr vec() = default;
+    constexpr vec(float x, float y) : x(x), y(y) {}
+    template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+    constexpr vec(const E& e) : x(e[0]), y(e[1]) { static_assert(E::size == 2 || E::size == 0); }
+    constexpr float operator[](std::size_t i) const { return i == 0 ? x : y; }
+    constexpr float& operator[](std::size_t i) { return i == 0 ? x : y; }
+};
+
+template<>
+struct vec<3> : vec_ops<vec<3>, 3> {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    constexpr vec() = default;
+    constexpr vec(float x, float y, float z) : x(x), y(y), z(z) {}
+    template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+    constexpr vec(const E& e) : x(e[0]), y(e[1]), z(e[2]) { static_assert(E::size == 3 || E::size == 0); }
+    constexpr float operator[](std::size_t i) const { return i == 0 ? x : i == 1 ? y : z; }
+    constexpr float& operator[](std::size_t i) { return i == 0 ? x : i == 1 ? y : z; }
+};
+
+template<>
+struct alignas(alignof(V4f)) vec<4> : vec_ops<vec<4>, 4> {
+    float x = 0.0f, y = 0.0f, z = 0.0f, w = 0.0f;
+    constexpr vec() = default;
+    constexpr vec(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+    constexpr vec(const E& e) : x(e[0]), y(e[1]), z(e[2]), w(e[3]) { static_assert(E::size == 4 || E::size == 0); }
+    constexpr float operator[](std::size_t i) const { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
+    constexpr float& operator[](std::size_t i) { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
+};
+
+using vec2 = vec<2>;
+using vec3 = vec<3>;
+using vec4 = vec<4>;
+
+// Operators, at least one side has to be a vector or an expression
+#define CGM_HPP_BINARY_OPERATOR(symbol, op_type)                                                        \
+    template<class L, class R, class = std::enable_if_t<(detail::is_expr_v<L> || detail::is_expr_v<R>) \
+            && detail::is_operand_v<L> && detail::is_operand_v<R>>>                                     \
+    constexpr auto operator symbol(const L& l, const R& r)                                              \
+    {                                                                                                   \
+        using left = detail::wrapped_t<L>;                                                              \
+        using right = detail::wrapped_t<R>;                                                             \
+        return detail::binary<detail::op_type, left, right>(detail::wrap(l), detail::wrap(r));         \
+    }
+CGM_HPP_BINARY_OPERATOR(+, add)
+CGM_HPP_BINARY_OPERATOR(-, sub)
+CGM_HPP_BINARY_OPERATOR(*, mul)
+CGM_HPP_BINARY_OPERATOR(/, div)
+#undef CGM_HPP_BINARY_OPERATOR
+
+template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+constexpr auto operator-(const E& e) { return detail::negate<E>(e); }
+
+template<std::size_t N>
+constexpr bool operator==(const vec<N>& a, const vec<N>& b)
+{
+    for(std::size_t i = 0; i < N; ++i) {
+        if(a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+template<std::size_t N>
+constexpr bool operator!=(const vec<N>& a, const vec<N>& b) { return !(a == b); }
+
+// Evaluates an expression, `eval(a*b + c)` when `auto` would otherwise keep the expression
+template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+constexpr vec<E::size> eval(const E& e) { return vec<E::size>(e); }
+
+template<class A, class B, class = std::enable_if_t<detail::is_expr_v<A> && detail::is_expr_v<B>>>
+constexpr float dot(const A& a, const B& b)
+{
+    static_assert(A::size == B::size && A::size > 0, "cgm: dot of vectors of different sizes");
+    float sum = a[0] * b[0];
+    for(std::size_t i = 1; i < A::size; ++i) sum = detail::fmadd(a[i], b[i], sum);
+    return sum;
+}
+
+template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+constexpr float length(const E& e) { return detail::sqrt(dot(e, e)); }
+
+template<class A, class B, class = std::enable_if_t<detail::is_expr_v<A> && detail::is_expr_v<B>>>
+constexpr float distance(const A& a, const B& b) { return length(eval(a - b)); }
+
+template<class E, class = std::enable_if_t<detail::is_expr_v<E>>>
+constexpr vec<E::size> normalize(const E& e)
+{
+    vec<E::size> v(e);
+    return eval(v * (1.0f / length(v)));
+}
+
+constexpr vec3 cross(const vec3& a, const vec3& b)
+{
+    return vec3(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+}
+
+struct alignas(alignof(M4f)) mat4 {
+    float elements[16] = {};
+
+    constexpr mat4() = default;
+    constexpr explicit mat4(float diagonal) : elements{}
+    {
+        elements[0] = elements[5] = elements[10] = elements[15] = diagonal;
+    }
+
+    constexpr float operator()(std::size_t row, std::size_t col) const { return elements[row*4 + col]; }
+    constexpr float& operator()(std::size_t row, std::size_t col) { return elements[row*4 + col]; }
+    constexpr vec4 row(std::size_t r) const { return vec4(elements[r*4], elements[r*4 + 1], elements[r*4 + 2], elements[r*4 + 3]); }
+
+    static constexpr mat4 identity() { return mat4(1.0f); }
+
+    static constexpr mat4 ortho(float left, float right, float bottom, float top, float near, float far)
+    {
+        mat4 res(1.0f);
+        float lr = 1.0f / (left - right);
+        float bt = 1.0f / (bottom - top);
+        float nf = 1.0f / (near - far);
+        res.elements[0] = -2.0f * lr;
+        res.elements[5] = -2.0f * bt;
+        res.elements[10] = 2.0f * nf;
+        res.elements[12] = (left + right) * lr;
+        res.elements[13] = (top + bottom) * bt;
+        res.elements[14] = (near + far) * nf;
+        return res;
+    }
+
+    static constexpr mat4 perspective(float fov, float aspect_ratio, float near, float far)
+    {
+        float s = 0.0f, c = 0.0f;
+        detail::sincos(fov * 0.5f, &s, &c);
+        float half_tan_fov = s / c;
+        mat4 res;
+        res.elements[0] = 1.0f / (aspect_ratio * half_tan_fov);
+        res.elements[5] = 1.0f / half_tan_fov;
+        res.elements[10] = -((far + near) / (far - near));
+        res.elements[11] = -1.0f;
+        res.elements[14] = -((2.0f * far * near) / (far - near));
+        return res;
+    }
+
+    static constexpr mat4 translate(const vec3& position)
+    {
+        mat4 res(1.0f);
+        res.elements[12] = position.x;
+        res.elements[13] = position.y;
+        res.elements[14] = position.z;
+        return res;
+    }
+
+    static constexpr mat4 scale(const vec3& scale)
+    {
+        mat4 res(1.0f);
+        res.elements[0] = scale.x;
+        res.elements[5] = scale.y;
+        res.elements[10] = scale.z;
+        return res;
+    }
+
+    // Same product as `m4f_rotate()`, x first, then y, then z
+    static constexpr mat4 rotate(const vec3& angles)
+    {
+        float sx = 0.0f, cx = 0.0f, sy = 0.0f, cy = 0.0f, sz = 0.0f, cz = 0.0f;
+        detail::sincos(angles.x, &sx, &cx);
+        detail::sincos(angles.y, &sy, &cy);
+        detail::sincos(angles.z, &sz, &cz);
+        mat4 res(1.0f);
+        res.elements[0]  = cy*cz;
+        res.elements[1]  = cy*sz;
+        res.elements[2]  = -sy;
+        res.elements[4]  = sx*sy*cz - cx*sz;
+        res.elements[5]  = sx*sy*sz + cx*cz;
+        res.elements[6]  = sx*cy;
+        res.elements[8]  = cx*sy*cz + sx*sz;
+        res.elements[9]  = cx*sy*sz - sx*cz;
+        res.elements[10] = cx*cy;
+        return res;
+    }
+    static constexpr mat4 rotate_x(float a) { return rotate(vec3(a, 0.0f, 0.0f)); }
+    static constexpr mat4 rotate_y(float a) { return rotate(vec3(0.0f, a, 0.0f)); }
+    static constexpr mat4 rotate_z(float a) { return rotate(vec3(0.0f, 0.0f, a)); }
+
+    constexpr mat4 transposed() const
+    {
+        mat4 res;
+        for(std::size_t i = 0; i < 4; ++i) {
+            for(std::size_t j = 0; j < 4; ++j) res.elements[j*4 + i] = elements[i*4 + j];
+        }
+        return res;
+    }
+};
+
+// `m4f_dot()`
+constexpr mat4 operator*(const mat4& a, const mat4& b)
+{
+    mat4 res;
+    for(std::size_t i = 0; i < 4; ++i) {
+        for(std::size_t j = 0; j < 4; ++j) {
+            float sum = a.elements[i*4] * b.elements[j];
+            for(std::size_t k = 1; k < 4; ++k) sum = detail::fmadd(a.elements[i*4 + k], b.elements[k*4 + j], sum);
+            res.elements[i*4 + j] = sum;
+        }
+    }
+    return res;
+}
+
+constexpr mat4& operator*=(mat4& a, const mat4& b) { return a = a * b; }
+
+// `v4f_transform()`
+constexpr vec4 operator*(const vec4& v, const mat4& m)
+{
+    vec4 res;
+    for(std::size_t j = 0; j < 4; ++j) {
+        float sum = v.x * m.elements[j];
+        sum = detail::fmadd(v.y, m.elements[4 + j], sum);
+        sum = detail::fmadd(v.z, m.elements[8 + j], sum);
+        res[j] = detail::fmadd(v.w, m.elements[12 + j], sum);
+    }
+    return res;
+}
+
+// `v3f_transform_point()`, w = 1 and no perspective divide
+constexpr vec3 transform_point(const vec3& p, const mat4& m)
+{
+    vec4 r = vec4(p.x, p.y, p.z, 1.0f) * m;
+    return vec3(r.x, r.y, r.z);
+}
+
+constexpr bool operator==(const mat4& a, const mat4& b)
+{
+    for(std::size_t i = 0; i < 16; ++i) {
+        if(a.elements[i] != b.elements[i]) return false;
+    }
+    return true;
+}
+
+constexpr bool operator!=(const mat4& a, const mat4& b) { return !(a == b); }
+
+// Interop with the C types
+static_assert(sizeof(vec2) == sizeof(V2f) && alignof(vec2) == alignof(V2f), "cgm: vec2 and V2f layouts differ");
+static_assert(sizeof(vec3) == sizeof(V3f) && alignof(vec3) == alignof(V3f), "cgm: vec3 and V3f layouts differ");
+static_assert(sizeof(vec4) == sizeof(V4f) && alignof(vec4) == alignof(V4f), "cgm: vec4 and V4f layouts differ");
+static_assert(sizeof(mat4) == sizeof(M4f) && alignof(mat4) == alignof(M4f), "cgm: mat4 and M4f layouts differ");
+static_assert(std::is_standard_layout_v<vec3> && std::is_trivially_copyable_v<vec3>, "cgm: vec3 is not C compatible");
+static_assert(std::is_standard_layout_v<mat4> && std::is_trivially_copyable_v<mat4>, "cgm: mat4 is not C compatible");
+
+inline vec2 from_c(V2f v) { return vec2(v.x, v.y); }
+inline vec3 from_c(V3f v) { return vec3(v.x, v.y, v.z); }
+inline vec4 from_c(V4f v) { return vec4(v.x, v.y, v.z, v.w); }
+inline mat4 from_c(const M4f& m)
+{
+    mat4 res;
+    for(std::size_t i = 0; i < 16; ++i) res.elements[i] = m.elements[i];
+    return res;
+}
+
+inline V2f to_c(const vec2& v) { return v2f(v.x, v.y); }
+inline V3f to_c(const vec3& v) { return v3f(v.x, v.y, v.z); }
+inline V4f to_c(const vec4& v) { return v4f(v.x, v.y, v.z, v.w); }
+inline M4f to_c(const mat4& m)
+{
+    M4f res;
+    for(std::size_t i = 0; i < 16; ++i) res.elements[i] = m.elements[i];
+    return res;
+}
+
+// Zero-copy views for the batch functions, e.g. `cgm_transform_v3f(as_c(&m), as_c(points), ...)`
+inline V2f* as_c(vec2* v) { return reinterpret_cast<V2f*>(v); }
+inline V3f* as_c(vec3* v) { return reinterpret_cast<V3f*>(v); }
+inline V4f* as_c(vec4* v) { return reinterpret_cast<V4f*>(v); }
+inline M4f* as_c(mat4* m) { return reinterpret_cast<M4f*>(m); }
+inline const V2f* as_c(const vec2* v) { return reinterpret_cast<const V2f*>(v); }
+inline const V3f* as_c(const vec3* v) { return reinterpret_cast<const V3f*>(v); }
+inline const V4f* as_c(const vec4* v) { return reinterpret_cast<const V4f*>(v); }
+inline const M4f* as_c(const mat4* m) { return reinterpret_cast<const M4f*>(m); }
+
+} // namespace cgm
+
+#endif // CGM_HPP
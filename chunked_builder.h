@@ -0,0 +1,173 @@
+#ifndef CHUNKED_BUILDER_H
+#define CHUNKED_BUILDER_H
+
+/**
+ * `Chunked_String_Builder` - a builder for outputs too large to reallocate
+ *
+ * Appends fill chunks of `chunk_size` bytes allocated from an `Arena` and never
+ * move the bytes already written, so a huge output costs no growth copies and
+ * never needs twice its size. `sb_flush_to_fd()` writes the chunks as they are
+ * with `writev()`, resuming after short writes and waiting on a non-blocking
+ * `fd` that is full. `sb_flatten()` copies them into one NUL-terminated view
+ * for callers that need it contiguous. Memory goes away with the arena.
+ *
+ * `common.h` and `arena.h` must be implemented somewhere.
+ */
+
+#include "arena.h"
+#include "common.h"
+
+#define SB_CHUNK_DEFAULT_SIZE (64*1024)
+
+typedef struct String_Chunk String_Chunk;
+struct String_Chunk {
+    String_Chunk* next;
+    size_t count, capacity;
+    char* data;
+};
+
+typedef struct {
+    Arena* arena;
+    size_t chunk_size;
+    String_Chunk* first;
+    String_Chunk* last;
+    size_t count;
+} Chunked_String_Builder;
+
+void sb_chunked_init(Chunked_String_Builder* sb, Arena* arena, size_t chunk_size); // 0 is SB_CHUNK_DEFAULT_SIZE
+void sb_chunked_append(Chunked_String_Builder* sb, const void* data, size_t size);
+void sb_chunked_appendf(Chunked_String_Builder* sb, const char* fmt, ...);
+#define sb_chunked_append_sv(sb, sv) sb_chunked_append(sb, (sv).data, (sv).count)
+#define sb_chunked_append_cstr(sb, cstr) sb_chunked_append(sb, cstr, __common_strlen(cstr))
+String_View sb_flatten(const Chunked_String_Builder* sb, Arena* arena);
+#if !defined(COMMON_PLATFORM_INDEPENDENT) && !PLATFORM_WINDOWS
+bool sb_flush_to_fd(const Chunked_String_Builder* sb, int fd);
+#endif
+
+#endif // CHUNKED_BUILDER_H
+
+#ifdef CHUNKED_BUILDER_IMPLEMENTATION
+
+#include <stdarg.h>
+#include <stdio.h>  // vsnprintf
+#include <string.h> // memcpy, memset
+
+#if !defined(COMMON_PLATFORM_INDEPENDENT) && !PLATFORM_WINDOWS
+    #include <errno.h>
+    #include <poll.h>
+    #include <sys/uio.h>
+#endif
+
+#define SB_FLUSH_IOV_COUNT 128
+
+void sb_chunked_init(Chunked_String_Builder* sb, Arena* arena, size_t chunk_size)
+{
+    memset(sb, 0, sizeof(*sb));
+    sb->arena = arena;
+    sb->chunk_size = chunk_size == 0 ? SB_CHUNK_DEFAULT_SIZE : chunk_size;
+}
+
+// A single append larger than a chunk gets a chunk of its own size
+static String_Chunk* sb_chunked__grow(Chunked_String_Builder* sb, size_t min_capacity)
+{
+    size_t capacity = sb->chunk_size > min_capacity ? sb->chunk_size : min_capacity;
+    String_Chunk* chunk = arena_alloc_aligned(sb->arena, sizeof(*chunk) + capacity, sizeof(void*));
+    chunk->next = NULL;
+    chunk->count = 0;
+    chunk->capacity = capacity;
+    chunk->data = (char*)(chunk + 1);
+    if(sb->last != NULL) sb->last->next = chunk;
+    else sb->first = chunk;
+    sb->last = chunk;
+    return chunk;
+}
+
+void sb_chunked_append(Chunked_String_Builder* sb, const void* data, size_t size)
+{
+    const char* bytes = data;
+    sb->count += size;
+    while(size > 0) {
+        String_Chunk* chunk = sb->last;
+        if(chunk == NULL || chunk->count == chunk->capacity) chunk = sb_chunked__grow(sb, size);
+        size_t n = chunk->capacity - chunk->count < size ? chunk->capacity - chunk->count : size;
+        memcpy(chunk->data + chunk->count, bytes, n);
+        chunk->count += n;
+        bytes += n;
+        size -= n;
+    }
+}
+
+void sb_chunked_appendf(Chunked_String_Builder* sb, const char* fmt, ...)
+{
+    // Formatted straight into the last chunk, a fresh one when it does not fit
+    String_Chunk* chunk = sb->last;
+    size_t available = chunk == NULL ? 0 : chunk->capacity - chunk->count;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(chunk == NULL ? NULL : chunk->data + chunk->count, available, fmt, args);
+    va_end(args);
+    if(n <= 0) return;
+    if((size_t)n >= available) {
+        chunk = sb_chunked__grow(sb, (size_t)n + 1);
+        va_start(args, fmt);
+        vsnprintf(chunk->data, chunk->capacity, fmt, args);
+        va_end(args);
+    }
+    chunk->count += (size_t)n;
+    sb->count += (size_t)n;
+}
+
+String_View sb_flatten(const Chunked_String_Builder* sb, Arena* arena)
+{
+    char* data = arena_alloc(arena, sb->count + 1);
+    size_t offset = 0;
+    for(const String_Chunk* chunk = sb->first; chunk != NULL; chunk = chunk->next) {
+        memcpy(data + offset, chunk->data, chunk->count);
+        offset += chunk->count;
+    }
+    data[offset] = '\0';
+    return sv_from_parts(data, offset);
+}
+
+#if !defined(COMMON_PLATFORM_INDEPENDENT) && !PLATFORM_WINDOWS
+bool sb_flush_to_fd(const Chunked_String_Builder* sb, int fd)
+{
+    const String_Chunk* chunk = sb->first;
+    size_t offset = 0; // already written from `chunk`
+    struct iovec iov[SB_FLUSH_IOV_COUNT];
+    for(;;) {
+        int iov_count = 0;
+        size_t skip = offset;
+        for(const String_Chunk* c = chunk; c != NULL && iov_count < SB_FLUSH_IOV_COUNT; c = c->next, skip = 0) {
+            if(c->count == skip) continue;
+            iov[iov_count].iov_base = c->data + skip;
+            iov[iov_count].iov_len = c->count - skip;
+            iov_count += 1;
+        }
+        if(iov_count == 0) return true;
+
+        ssize_t written = writev(fd, iov, iov_count);
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            // A full non-blocking pipe or socket, wait until it drains
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                if(poll(&pfd, 1, -1) >= 0 || errno == EINTR) continue;
+            }
+            trace_log(TRACE_LOG_ERROR, "Could not write to fd %d: `%s`", fd, strerror(errno));
+            return false;
+        }
+
+        // A short write resumes in the middle of a chunk
+        size_t left = (size_t)written;
+        while(chunk != NULL && left >= chunk->count - offset) {
+            left -= chunk->count - offset;
+            chunk = chunk->next;
+            offset = 0;
+        }
+        offset += left;
+    }
+}
+#endif
+
+#endif // CHUNKED_BUILDER_IMPLEMENTATION
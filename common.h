@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,7 +98,26 @@ extern "C" {
     #define CC_GCC 0
 #endif
 
+// Opt-in SIMD string kernels, scalar code is used for whatever the compiler doesn't target
+#if defined(COMMON_SIMD) && defined(__AVX2__)
+    #define COMMON_SIMD_AVX2 1
+#endif
+#if defined(COMMON_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+    #define COMMON_SIMD_SSE2 1
+#endif
+#ifndef COMMON_SIMD_AVX2
+    #define COMMON_SIMD_AVX2 0
+#endif
+#ifndef COMMON_SIMD_SSE2
+    #define COMMON_SIMD_SSE2 0
+#endif
+// `sv_utf8_to_utf32()` inputs of at least this many bytes write the codepoints with non-temporal stores
+#ifndef COMMON_UTF8_STREAM_THRESHOLD
+    #define COMMON_UTF8_STREAM_THRESHOLD (8*1024*1024)
+#endif
+
 void* __common_memcpy(void* dst, const void* src, size_t size);
+void* __common_memmove(void* dst, const void* src, size_t size);
 size_t __common_strlen(const char* cstr);
 
 bool __common_iswhitespace(char c);
@@ -124,6 +144,62 @@ bool __common_isdigit(char c);
     #error "`common.h` requires you to define `COMMON_ALLOC()`, `COMMON_FREE()`, `COMMON_REALLOC()` macros"
 #endif
 
+/**
+ * `COMMON_TRACK_ALLOCS` - per-callsite allocation statistics
+ *
+ * Wraps `COMMON_MALLOC`/`COMMON_REALLOC`/`COMMON_FREE` (whatever they were
+ * defined to) so every call records its `__FILE__`/`__LINE__`. The `da_*`
+ * macros expand at the caller, so `da_append()` growth shows up at the line
+ * that appended. Counters are atomics in a fixed table of
+ * `COMMON_TRACK_MAX_SITES` slots (a power of two, extra sites go to one
+ * `<other>` slot), each block carries a 16 bytes header with its size and site.
+ * Define it the same way in every translation unit, memory allocated with
+ * tracking must be freed with tracking.
+ *
+ * A realloc that moved the block counts as a copy of the old size, that is
+ * the cost worth removing with `da_reserve()`. `common_alloc_sites()` copies
+ * the sites sorted by copied bytes, then total bytes, and
+ * `common_alloc_report()` logs the top `max_sites` of them.
+ */
+#ifdef COMMON_TRACK_ALLOCS
+    #if CC_MSVC
+        #error "`COMMON_TRACK_ALLOCS` needs the GCC/Clang `__atomic` builtins"
+    #endif
+    #ifndef COMMON_TRACK_MAX_SITES
+        #define COMMON_TRACK_MAX_SITES 4096
+    #endif
+
+typedef struct {
+    const char* file;
+    int line;
+    size_t count;               // malloc and realloc calls
+    size_t bytes;               // requested by those calls
+    size_t live_bytes;          // allocated here and not freed yet
+    size_t frees;
+    size_t realloc_copies;
+    size_t realloc_copy_bytes;
+} Common_Alloc_Site;
+
+size_t common_alloc_sites(Common_Alloc_Site* sites, size_t max_sites);
+void common_alloc_report(size_t max_sites);
+
+void* common__track_malloc(size_t size, const char* file, int line);
+void* common__track_realloc(void* ptr, size_t size, const char* file, int line);
+void common__track_free(void* ptr);
+
+// The allocator as configured above, captured before the macros are replaced
+static inline void* common__raw_malloc(size_t size) { return COMMON_MALLOC(size); }
+static inline void* common__raw_realloc(void* ptr, size_t size) { return COMMON_REALLOC(ptr, size); }
+static inline void common__raw_free(void* ptr) { COMMON_FREE(ptr); }
+
+    #undef COMMON_MALLOC
+    #undef COMMON_REALLOC
+    #undef COMMON_FREE
+    #define COMMON_MALLOC(size) common__track_malloc((size), __FILE__, __LINE__)
+    #define COMMON_REALLOC(ptr, size) common__track_realloc((ptr), (size), __FILE__, __LINE__)
+    #define COMMON_FREE(ptr) common__track_free(ptr)
+#endif // COMMON_TRACK_ALLOCS
+
 #define CAST(T, a) ((T)(a))
 #define SWAP(T, a, b)   \
     do {                \
@@ -135,31 +211,119 @@ bool __common_isdigit(char c);
 #define DA_INIT_CAPACITY 32
 #define da(T) struct { T* data; size_t count, capacity; }
 #define da_free(da) COMMON_FREE((da)->data)
-#define da_append(da, item) \
-    do {                                                            \
-        if((da)->count >= (da)->capacity) {                         \
-            size_t new_capacity = (da)->capacity * 2;               \
-            if(new_capacity == 0) new_capacity = DA_INIT_CAPACITY;  \
-            (da)->data = COMMON_REALLOC((da)->data,                 \
-                    new_capacity * sizeof(*(da)->data));            \
-            (da)->capacity = new_capacity;                          \
-        }                                                           \
-        (da)->data[(da)->count++] = (item);                         \
+
+// Grow to at least `expected_capacity` items with a single reallocation
+#define da_reserve(da, expected_capacity)                                   \
+    do {                                                                    \
+        if((expected_capacity) > (da)->capacity) {                          \
+            size_t new_capacity = (da)->capacity;                           \
+            if(new_capacity == 0) new_capacity = DA_INIT_CAPACITY;          \
+            while(new_capacity < (expected_capacity)) new_capacity *= 2;    \
+            (da)->data = COMMON_REALLOC((da)->data,                         \
+                    new_capacity * sizeof(*(da)->data));                    \
+            (da)->capacity = new_capacity;                                  \
+        }                                                                   \
     } while(0)
 
+#define da__append(reserve, da, item)                                       \
+    do {                                                                    \
+        if((da)->count >= (da)->capacity) reserve(da, (da)->count + 1);     \
+        (da)->data[(da)->count++] = (item);                                 \
+    } while(0)
+
+#define da__append_many(reserve, da, new_items, new_items_count)            \
+    do {                                                                    \
+        size_t da__n = (new_items_count);                                   \
+        reserve(da, (da)->count + da__n);                                   \
+        __common_memcpy((da)->data + (da)->count, new_items,                \
+                da__n * sizeof(*(da)->data));                               \
+        (da)->count += da__n;                                               \
+    } while(0)
+
+// New items are left uninitialized
+#define da__resize(reserve, da, new_count)                                  \
+    do {                                                                    \
+        size_t da__n = (new_count);                                         \
+        reserve(da, da__n);                                                 \
+        (da)->count = da__n;                                                \
+    } while(0)
+
+#define da__insert_many(reserve, da, index, new_items, new_items_count)     \
+    do {                                                                    \
+        size_t da__i = (index);                                             \
+        size_t da__n = (new_items_count);                                   \
+        COMMON_ASSERT(da__i <= (da)->count);                                \
+        reserve(da, (da)->count + da__n);                                   \
+        __common_memmove((da)->data + da__i + da__n, (da)->data + da__i,    \
+                ((da)->count - da__i) * sizeof(*(da)->data));               \
+        __common_memcpy((da)->data + da__i, new_items,                      \
+                da__n * sizeof(*(da)->data));                               \
+        (da)->count += da__n;                                               \
+    } while(0)
+
+#define da_append(da, item) da__append(da_reserve, da, item)
 #define da_append_many(da, new_items, new_items_count) \
-    do {                                                                \
-        if((da)->count + new_items_count > (da)->capacity) {            \
-            if((da)->capacity == 0) (da)->capacity = DA_INIT_CAPACITY;  \
-            (da)->capacity = (da)->capacity * 2 + new_items_count;      \
-            (da)->data = COMMON_REALLOC((da)->data,                     \
-                    (da)->capacity * sizeof(*(da)->data));              \
-        }                                                               \
-        __common_memcpy((da)->data + (da)->count, new_items,            \
-                new_items_count * sizeof(*(da)->data));                 \
-        (da)->count += new_items_count;                                 \
+    da__append_many(da_reserve, da, new_items, new_items_count)
+#define da_resize(da, new_count) da__resize(da_reserve, da, new_count)
+#define da_insert_many(da, index, new_items, new_items_count) \
+    da__insert_many(da_reserve, da, index, new_items, new_items_count)
+
+// Does not keep the order, the last item takes the place of the removed one
+#define da_remove_swap(da, index)                                           \
+    do {                                                                    \
+        size_t da__i = (index);                                             \
+        COMMON_ASSERT(da__i < (da)->count);                                 \
+        (da)->data[da__i] = (da)->data[--(da)->count];                      \
     } while(0)
 
+/**
+ * `da_inline(T, N)` - dynamic array with room for `N` items inside the struct
+ *
+ * Zero initialization works like `da(T)`, the first append points `data` at
+ * the inline storage and only growing past `N` items allocates. Because `data`
+ * may point into the struct itself, don't copy it by value while it is inline.
+ * Growing, appending and freeing must go through the `da_inline_*` macros, the
+ * rest of `da_*` (indexing, `da_remove_swap`) works on both.
+ */
+#define da_inline(T, N) struct { T* data; size_t count, capacity; T inline_data[N]; }
+#define da_inline_capacity(da) (sizeof((da)->inline_data) / sizeof(*(da)->inline_data))
+#define da_inline_free(da)                                                  \
+    do {                                                                    \
+        if((da)->data != (da)->inline_data) COMMON_FREE((da)->data);        \
+        (da)->data = NULL;                                                  \
+        (da)->count = 0;                                                    \
+        (da)->capacity = 0;                                                 \
+    } while(0)
+
+#define da_inline_reserve(da, expected_capacity)                            \
+    do {                                                                    \
+        if((da)->data == NULL) {                                            \
+            (da)->data = (da)->inline_data;                                 \
+            (da)->capacity = da_inline_capacity(da);                        \
+        }                                                                   \
+        if((expected_capacity) > (da)->capacity) {                          \
+            size_t new_capacity = (da)->capacity * 2;                       \
+            while(new_capacity < (expected_capacity)) new_capacity *= 2;    \
+            if((da)->data == (da)->inline_data) {                           \
+                (da)->data = COMMON_MALLOC(                                 \
+                        new_capacity * sizeof(*(da)->data));                \
+                __common_memcpy((da)->data, (da)->inline_data,              \
+                        (da)->count * sizeof(*(da)->data));                 \
+            } else {                                                        \
+                (da)->data = COMMON_REALLOC((da)->data,                     \
+                        new_capacity * sizeof(*(da)->data));                \
+            }                                                               \
+            (da)->capacity = new_capacity;                                  \
+        }                                                                   \
+    } while(0)
+
+#define da_inline_append(da, item) da__append(da_inline_reserve, da, item)
+#define da_inline_append_many(da, new_items, new_items_count) \
+    da__append_many(da_inline_reserve, da, new_items, new_items_count)
+#define da_inline_resize(da, new_count) da__resize(da_inline_reserve, da, new_count)
+#define da_inline_insert_many(da, index, new_items, new_items_count) \
+    da__insert_many(da_inline_reserve, da, index, new_items, new_items_count)
+
 typedef struct {
     const char* data;
     size_t count;
@@ -193,15 +357,129 @@ String_View sv_chop_by_delim(String_View* strv, char delim);
 String_View sv_chop_by_sv(String_View* strv, String_View sv);
 int sv_to_int(String_View strv);
 
+/**
+ * UTF-8
+ *
+ * `sv_utf8_validate()` rejects overlongs, surrogates, codepoints past U+10FFFF
+ * and truncated sequences. With `COMMON_SIMD` and AVX2 it checks 32 bytes per
+ * iteration with the lookup-table algorithm from simdutf (Keiser & Lemire),
+ * skipping pure ASCII blocks.
+ * `sv_utf8_count_codepoints()` expects valid input.
+ * `sv_utf8_next()` decodes and chops the first codepoint of a non-empty view,
+ * an invalid byte decodes to `SV_UTF8_REPLACEMENT` and is skipped alone.
+ * `sv_utf8_to_utf32()` appends the codepoints to `out`, it leaves `out->count`
+ * untouched and returns false when `strv` is not valid UTF-8. It validates
+ * while decoding in a single pass and reserves room for `strv.count` codepoints.
+ * With AVX2 the decoder is table-driven, keyed by the sequence boundaries of
+ * each 4 byte chunk, and inputs of `COMMON_UTF8_STREAM_THRESHOLD` bytes and
+ * more write the codepoints with non-temporal stores.
+ */
+#define SV_UTF8_REPLACEMENT 0xFFFD
+typedef da(uint32_t) Codepoints;
+
+bool sv_utf8_validate(String_View strv);
+size_t sv_utf8_count_codepoints(String_View strv);
+uint32_t sv_utf8_next(String_View* strv);
+bool sv_utf8_to_utf32(String_View strv, Codepoints* out);
+
+/**
+ * Case-insensitive comparison, ASCII letters only (HTTP headers, config keys)
+ *
+ * Unlike `sv_eq()`, `sv_eq_ci()` requires both views to have the same length.
+ * With `COMMON_SIMD` they fold and compare 16 bytes at a time, `sv_find_ci()`
+ * filters candidates on the first and last byte of `sth` before comparing.
+ */
+bool sv_eq_ci(String_View a, String_View b);
+bool sv_has_prefix_ci(String_View strv, String_View prefix);
+int sv_find_ci(String_View strv, String_View sth, size_t index);
+
+/**
+ * 64-bit hash (wyhash), not cryptographic
+ *
+ * `Hash64` hashes data that arrives in pieces, e.g. a `String_Builder` as it's
+ * being built, and gives the same result as `sv_hash64()` over the whole data.
+ */
+typedef struct {
+    uint64_t seed, see1, see2;
+    size_t total;
+    size_t pending;
+    unsigned char buffer[64]; // the last 16 bytes already mixed, then `pending` bytes
+} Hash64;
+
+uint64_t sv_hash64(String_View strv, uint64_t seed);
+void hash64_init(Hash64* h, uint64_t seed);
+void hash64_update(Hash64* h, String_View data);
+uint64_t hash64_final(const Hash64* h);
+
 typedef da(char) String_Builder;
 #define sb_append(sb, cstr, cstr_length) da_append_many(sb, cstr, cstr_length + 1)
 #define sb_append_cstr(sb, cstr) da_append_many(sb, cstr, __common_strlen(cstr) + 1)
 #define sb_free(sb) da_free(sb)
 
+#if !CC_MSVC
+
+/**
+ * Bounded lock-free queues for passing items between threads
+ *
+ * `Spsc_Queue` is a wait-free ring for exactly one producer and one consumer.
+ * `Mpmc_Queue` is Dmitry Vyukov's bounded queue where every cell carries a
+ * sequence number, any number of threads may push and pop. Items are copied
+ * by value (`item_size` bytes) and the capacity is rounded up to a power of two.
+ *
+ * The `*_pop_wait()` variants park an idle consumer on a futex (Linux) instead
+ * of spinning, producers only pay for a wake-up syscall when someone sleeps.
+ */
+#define COMMON_CACHE_LINE 64
+#define COMMON_CACHE_ALIGNED __attribute__((aligned(COMMON_CACHE_LINE)))
+
+typedef struct {
+    unsigned int word;
+    unsigned int waiters;
+} Queue_Waiter;
+
+typedef struct {
+    COMMON_CACHE_ALIGNED size_t head;
+    size_t cached_tail;
+    COMMON_CACHE_ALIGNED size_t tail;
+    size_t cached_head;
+    COMMON_CACHE_ALIGNED char* data;
+    size_t item_size, mask;
+    Queue_Waiter waiter;
+} Spsc_Queue;
+
+bool spsc_init(Spsc_Queue* q, size_t item_size, size_t capacity);
+void spsc_deinit(Spsc_Queue* q);
+bool spsc_push(Spsc_Queue* q, const void* item);
+bool spsc_pop(Spsc_Queue* q, void* item);
+size_t spsc_push_many(Spsc_Queue* q, const void* items, size_t count);
+size_t spsc_pop_many(Spsc_Queue* q, void* items, size_t count);
+void spsc_pop_wait(Spsc_Queue* q, void* item);
+size_t spsc_pop_many_wait(Spsc_Queue* q, void* items, size_t count);
+
+typedef struct {
+    COMMON_CACHE_ALIGNED size_t enqueue_pos;
+    COMMON_CACHE_ALIGNED size_t dequeue_pos;
+    COMMON_CACHE_ALIGNED char* cells;
+    size_t cell_size, item_size, mask;
+    Queue_Waiter waiter;
+} Mpmc_Queue;
+
+bool mpmc_init(Mpmc_Queue* q, size_t item_size, size_t capacity);
+void mpmc_deinit(Mpmc_Queue* q);
+bool mpmc_push(Mpmc_Queue* q, const void* item);
+bool mpmc_pop(Mpmc_Queue* q, void* item);
+size_t mpmc_push_many(Mpmc_Queue* q, const void* items, size_t count);
+size_t mpmc_pop_many(Mpmc_Queue* q, void* items, size_t count);
+void mpmc_pop_wait(Mpmc_Queue* q, void* item);
+size_t mpmc_pop_many_wait(Mpmc_Queue* q, void* items, size_t count);
+
+#endif // !CC_MSVC
+
 #ifndef COMMON_PLATFORM_INDEPENDENT
 
 typedef da(String_View) Path_List;
 bool mkdir_if_not_exists(const char* path);
+// Both compare contents instead of mtimes while a `Build_Cache` is open, see below
 bool copy_file(const char* dst_path, const char* src_path);
 bool copy_dir_recursive(const char* dst_path, const char* src_path);
 bool read_dir(const char* path, Path_List* children);
@@ -209,6 +487,174 @@ bool read_dir(const char* path, Path_List* children);
 bool load_file_data(const char* path, String_Builder* sb);
 bool save_file_data(const char* path, const void* data, size_t size);
 
+#if PLATFORM_LINUX
+/**
+ * `File_Watcher` - inotify over whole directory trees
+ *
+ * `watcher_add_tree()` watches a directory and every directory below it,
+ * directories created or moved in later are watched as they appear.
+ * `watcher_wait()` blocks until something changes, then keeps collecting until
+ * no event arrived for `debounce_ms` (a steady stream is cut after 8 windows)
+ * and fills `changed` with every path that was created, written, moved or
+ * deleted, each path once. The views are valid until the next `watcher_wait()`.
+ *
+ * When the kernel queue overflows events are lost, the roots are reported
+ * instead and the caller should rescan them.
+ */
+typedef struct {
+    int fd;
+    int debounce_ms;
+    da(char*) dir_paths;    // by watch descriptor, NULL when not watched
+    da(char*) roots;
+    Path_List changed;
+    uint32_t* seen;         // open addressing over changed, 0 is empty
+    size_t seen_count;
+} File_Watcher;
+
+bool watcher_init(File_Watcher* w, int debounce_ms);
+bool watcher_add_tree(File_Watcher* w, const char* root);
+bool watcher_wait(File_Watcher* w, int timeout_ms); // -1 waits forever, false on timeout
+void watcher_free(File_Watcher* w);
+#endif // PLATFORM_LINUX
+
+#if !PLATFORM_WINDOWS
+
+/**
+ * `Cmd` - build an argument list and run it without a shell
+ *
+ * `cmd_run_async()` starts the command with `posix_spawnp()` (looked up in
+ * PATH, inheriting stdio and the environment). `Procs` keeps at most
+ * `max_jobs` commands running: `procs_run()` first reaps finished ones, waiting
+ * for a free slot when all are busy, and `procs_wait_all()` drains the rest.
+ * Only its own children are reaped, blocking on pidfds where Linux has them.
+ * Every command ends up in `results`, in completion order, with the wall time
+ * from spawn until the pool reaped it.
+ */
+typedef da(const char*) Cmd;
+#define cmd_append(cmd, ...)                                                    \
+    da_append_many(cmd, ((const char*[]){ __VA_ARGS__ }),                       \
+            sizeof((const char*[]){ __VA_ARGS__ }) / sizeof(const char*))
+
+typedef int Proc;
+#define INVALID_PROC (-1)
+
+Proc cmd_run_async(const Cmd* cmd);
+bool proc_wait(Proc proc, int* exit_code);
+bool cmd_run_sync(const Cmd* cmd);
+
+typedef struct {
+    size_t index;           // order of the procs_run() call
+    Proc proc;
+    int exit_code;          // 128 + signal number when killed by a signal
+    bool ok;                // exited with 0
+    double wall_seconds;
+} Proc_Result;
+
+typedef struct {
+    Proc proc;
+    int pidfd;              // -1 when unavailable
+    size_t index;
+    double start;
+} Procs_Slot;
+
+typedef struct {
+    size_t max_jobs;
+    size_t submitted;
+    da(Procs_Slot) running;
+    da(Proc_Result) results;
+} Procs;
+
+void procs_init(Procs* ps, size_t max_jobs); // 0 is one job per online CPU
+bool procs_run(Procs* ps, const Cmd* cmd);
+bool procs_wait_all(Procs* ps);              // true when every result so far is ok
+void procs_free(Procs* ps);
+
+/**
+ * Incremental builds
+ *
+ * `file_hash64()` never loads the whole file: it is split into
+ * `FILE_HASH_CHUNK_SIZE` chunks that are streamed through `Hash64` on every
+ * core, and the chunk hashes are hashed together.
+ *
+ * A `Build_Cache` is an on-disk index of path -> size, mtime and content hash.
+ * While one is open, a file whose size and mtime did not change is not hashed
+ * again, `copy_file()` and `copy_dir_recursive()` skip destinations that already
+ * hold the same content, and `needs_rebuild()` compares the contents of the
+ * inputs with the last time it saw the output up to date, so touching an input
+ * without changing it does not trigger a rebuild. Without an open cache they
+ * fall back to sizes and modification times, like make.
+ *
+ * The open cache is a hidden process-wide global: `build_cache_open()` makes
+ * it the one used by `copy_file()`, `copy_dir_recursive()` and
+ * `needs_rebuild()` until `build_cache_close()`, only when it succeeds. Opening
+ * a second one replaces the first. None of this is thread safe, open, use and
+ * close a cache from a single thread.
+ */
+#define FILE_HASH_CHUNK_SIZE (4*1024*1024)
+
+typedef struct {
+    char* path;
+    uint64_t size;
+    int64_t mtime_ns;
+    uint64_t hash;          // content, 0 when not hashed yet
+    uint64_t inputs_hash;   // inputs of an up to date output, 0 when unknown
+} Build_Cache_Entry;
+
+typedef struct {
+    char* index_path;
+    da(Build_Cache_Entry) entries;
+    uint32_t* slots;        // open addressing over entries, 0 is empty
+    size_t slot_count;
+    bool changed;
+} Build_Cache;
+
+bool file_hash64(const char* path, uint64_t* hash);
+bool build_cache_open(Build_Cache* cache, const char* index_path); // a missing index starts empty, `cache` is zeroed on failure
+bool build_cache_close(Build_Cache* cache);                        // saves the index when it changed
+bool needs_rebuild(const char* output, const char** inputs, size_t input_count);
+
+/**
+ * `Stream_Reader` - read files that are too large to load with `load_file_data`
+ *
+ * The file is read in `chunk_size` pieces into two slots. While the records of
+ * one slot are being parsed the next chunk is already being read into the other
+ * slot (through io_uring when the kernel allows it, otherwise through a pread
+ * worker thread). A record crossing a chunk boundary is made contiguous by
+ * copying only the unparsed tail in front of the next chunk.
+ *
+ * Records follow `sv_chop_by_delim` semantics: the delimiter is not included and
+ * the last record does not need a trailing delimiter. A returned view is only
+ * valid until the next call on the same reader.
+ */
+#define STREAM_READER_DEFAULT_CHUNK_SIZE (1024*1024)
+
+typedef struct Stream_Reader_Backend Stream_Reader_Backend;
+
+typedef struct {
+    char* data;
+    size_t prefix; // bytes reserved in front of the chunk for a carried tail
+} Stream_Reader_Slot;
+
+typedef struct {
+    int fd;
+    bool opened;    // owns `fd`, a zeroed reader is safe to close
+    size_t chunk_size;
+    size_t file_offset;
+    Stream_Reader_Slot slots[2];
+    size_t current;
+    String_View window;
+    bool pending;
+    bool eof;
+    Stream_Reader_Backend* backend;
+} Stream_Reader;
+
+bool sr_open(Stream_Reader* sr, const char* path, size_t chunk_size);
+void sr_close(Stream_Reader* sr);
+bool sr_next_record(Stream_Reader* sr, char delim, String_View* record);
+bool sr_next_line(Stream_Reader* sr, String_View* line);
+
+#endif // !PLATFORM_WINDOWS
+
 #endif // COMMON_PLATFORM_INDEPENDENT
 
 typedef enum {
@@ -232,6 +678,14 @@ void trace_log(Trace_Log_Level level, const char* fmt, ...);
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
+
+#if COMMON_SIMD_AVX2 || COMMON_SIMD_SSE2
+    #include <immintrin.h>
+#endif
+#if CC_MSVC
+    #include <intrin.h>
+#endif
 
 #ifndef COMMON_PLATFORM_INDEPENDENT
     #if PLATFORM_WINDOWS
@@ -253,6 +707,18 @@ void trace_log(Trace_Log_Level level, const char* fmt, ...);
         #include <sys/stat.h>
         #include <unistd.h>
         #include <fcntl.h>
+        #include <pthread.h>
+        #include <sched.h>
+        #include <spawn.h>
+        #include <poll.h>
+        #include <time.h>
+        #if PLATFORM_LINUX
+            #include <sys/mman.h>
+            #include <sys/syscall.h>
+            #include <linux/io_uring.h>
+            #include <linux/futex.h>
+            #include <sys/inotify.h>
+        #endif
     #endif
 #endif
 
@@ -263,6 +729,15 @@ void* __common_memcpy(void* dst, const void* src, size_t size)
     return dst;
 }
 
+void* __common_memmove(void* dst, const void* src, size_t size)
+{
+    if(CAST(char*, dst) <= CAST(const char*, src))
+        return __common_memcpy(dst, src, size);
+    for(size_t i = size; i > 0; --i)
+        CAST(char*, dst)[i - 1] = CAST(const char*, src)[i - 1];
+    return dst;
+}
+
 size_t __common_strlen(const char* cstr)
 {
     size_t i = 0;
@@ -508,92 +983,2691 @@ int sv_to_int(String_View strv)
     return result;
 }
 
-void trace_log(Trace_Log_Level level, const char* fmt, ...)
+// Length of the valid sequence at `s` or 0, Unicode table 3-7
+static size_t common__utf8_decode(const unsigned char* s, size_t n, uint32_t* codepoint)
 {
-    FILE* f = level <= TRACE_LOG_WARN ? stdout : stderr;
-    switch(level) {
-        case TRACE_LOG_INFO: fprintf(f, "[INFO] ");
-        case TRACE_LOG_WARN: fprintf(f, "[WARN] ");
-        case TRACE_LOG_ERROR: fprintf(f, "[ERROR] ");
-        case TRACE_LOG_FATAL: fprintf(f, "[FATAL] ");
+    unsigned char b0 = s[0];
+    if(b0 < 0x80) {
+        *codepoint = b0;
+        return 1;
     }
+    if(b0 < 0xC2 || b0 > 0xF4) return 0;
+    if(b0 < 0xE0) {
+        if(n < 2 || (s[1] & 0xC0) != 0x80) return 0;
+        *codepoint = ((uint32_t)(b0 & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if(b0 < 0xF0) {
+        unsigned char lo = b0 == 0xE0 ? 0xA0 : 0x80;
+        unsigned char hi = b0 == 0xED ? 0x9F : 0xBF;
+        if(n < 3 || s[1] < lo || s[1] > hi || (s[2] & 0xC0) != 0x80) return 0;
+        *codepoint = ((uint32_t)(b0 & 0x0F) << 12) | ((uint32_t)(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        return 3;
+    }
+    unsigned char lo = b0 == 0xF0 ? 0x90 : 0x80;
+    unsigned char hi = b0 == 0xF4 ? 0x8F : 0xBF;
+    if(n < 4 || s[1] < lo || s[1] > hi || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80) return 0;
+    *codepoint = ((uint32_t)(b0 & 0x07) << 18) | ((uint32_t)(s[1] & 0x3F) << 12)
+        | ((uint32_t)(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+    return 4;
+}
 
-    va_list arg;
-    va_start(arg, fmt);
-    vfprintf(f, fmt, arg);
-    va_end(arg);
-    fprintf(f, "\n");
+static bool common__utf8_validate_scalar(const unsigned char* s, size_t n)
+{
+    size_t i = 0;
+    while(i < n) {
+        // Eight ASCII bytes at a time
+        if(i + 8 <= n) {
+            uint64_t word;
+            memcpy(&word, s + i, sizeof(word));
+            if((word & 0x8080808080808080ull) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        uint32_t codepoint;
+        size_t length = common__utf8_decode(s + i, n - i, &codepoint);
+        if(length == 0) return false;
+        i += length;
+    }
+    return true;
 }
 
-#ifndef COMMON_PLATFORM_INDEPENDENT
+#if COMMON_SIMD_AVX2
+
+#define common__utf8_prev(input, prev_input, n) \
+    _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev_input), (input), 0x21), 16 - (n))
+#define common__utf8_table(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// Error bits, set in all three lookups only when the two byte pattern is wrong
+#define COMMON__UTF8_TOO_SHORT      (1 << 0) // 11______ 0_______ or 11______ 11______
+#define COMMON__UTF8_TOO_LONG       (1 << 1) // 0_______ 10______
+#define COMMON__UTF8_OVERLONG_3     (1 << 2) // 11100000 100_____
+#define COMMON__UTF8_TOO_LARGE      (1 << 3) // 11110100 1001____ and above
+#define COMMON__UTF8_SURROGATE      (1 << 4) // 11101101 101_____
+#define COMMON__UTF8_OVERLONG_2     (1 << 5) // 1100000_ 10______
+#define COMMON__UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and above
+#define COMMON__UTF8_OVERLONG_4     (1 << 6) // 11110000 1000____
+#define COMMON__UTF8_TWO_CONTS      (-128)   // 10______ 10______
+#define COMMON__UTF8_CARRY (COMMON__UTF8_TOO_SHORT | COMMON__UTF8_TOO_LONG | COMMON__UTF8_TWO_CONTS)
+
+static inline __m256i common__utf8_check_block(__m256i input, __m256i prev_input)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i prev1 = common__utf8_prev(input, prev_input, 1);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(common__utf8_table(
+        COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG,
+        COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG, COMMON__UTF8_TOO_LONG,
+        COMMON__UTF8_TWO_CONTS, COMMON__UTF8_TWO_CONTS, COMMON__UTF8_TWO_CONTS, COMMON__UTF8_TWO_CONTS,
+        COMMON__UTF8_TOO_SHORT | COMMON__UTF8_OVERLONG_2,
+        COMMON__UTF8_TOO_SHORT,
+        COMMON__UTF8_TOO_SHORT | COMMON__UTF8_OVERLONG_3 | COMMON__UTF8_SURROGATE,
+        COMMON__UTF8_TOO_SHORT | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000 | COMMON__UTF8_OVERLONG_4),
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+
+    __m256i byte_1_low = _mm256_shuffle_epi8(common__utf8_table(
+        COMMON__UTF8_CARRY | COMMON__UTF8_OVERLONG_3 | COMMON__UTF8_OVERLONG_2 | COMMON__UTF8_OVERLONG_4,
+        COMMON__UTF8_CARRY | COMMON__UTF8_OVERLONG_2,
+        COMMON__UTF8_CARRY,
+        COMMON__UTF8_CARRY,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000 | COMMON__UTF8_SURROGATE,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000,
+        COMMON__UTF8_CARRY | COMMON__UTF8_TOO_LARGE | COMMON__UTF8_TOO_LARGE_1000),
+        _mm256_and_si256(prev1, nibble));
+
+    __m256i byte_2_high = _mm256_shuffle_epi8(common__utf8_table(
+        COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT,
+        COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT,
+        COMMON__UTF8_TOO_LONG | COMMON__UTF8_OVERLONG_2 | COMMON__UTF8_TWO_CONTS | COMMON__UTF8_OVERLONG_3
+            | COMMON__UTF8_TOO_LARGE_1000 | COMMON__UTF8_OVERLONG_4,
+        COMMON__UTF8_TOO_LONG | COMMON__UTF8_OVERLONG_2 | COMMON__UTF8_TWO_CONTS | COMMON__UTF8_OVERLONG_3
+            | COMMON__UTF8_TOO_LARGE,
+        COMMON__UTF8_TOO_LONG | COMMON__UTF8_OVERLONG_2 | COMMON__UTF8_TWO_CONTS | COMMON__UTF8_SURROGATE
+            | COMMON__UTF8_TOO_LARGE,
+        COMMON__UTF8_TOO_LONG | COMMON__UTF8_OVERLONG_2 | COMMON__UTF8_TWO_CONTS | COMMON__UTF8_SURROGATE
+            | COMMON__UTF8_TOO_LARGE,
+        COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT, COMMON__UTF8_TOO_SHORT),
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    // Third and fourth bytes must be continuations exactly where a 3/4 byte lead says so
+    __m256i prev2 = common__utf8_prev(input, prev_input, 2);
+    __m256i prev3 = common__utf8_prev(input, prev_input, 3);
+    __m256i is_third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i is_fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_be_cont = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_cont, special);
+}
 
-bool mkdir_if_not_exists(const char* path)
+// Non zero when the block ends in the middle of a sequence
+static inline __m256i common__utf8_incomplete(__m256i input)
 {
-#if PLATFORM_WINDOWS
-    int result = mkdir(path);
-#else
-    int result = mkdir(path, 0755);
-#endif
-    if(result < 0) {
-        if(errno == EEXIST) {
-            trace_log(TRACE_LOG_WARN, "Directory `%s` already exists", path);
-            return true;
+    const __m256i max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm256_subs_epu8(input, max);
+}
+
+#undef COMMON__UTF8_TOO_SHORT
+#undef COMMON__UTF8_TOO_LONG
+#undef COMMON__UTF8_OVERLONG_3
+#undef COMMON__UTF8_TOO_LARGE
+#undef COMMON__UTF8_SURROGATE
+#undef COMMON__UTF8_OVERLONG_2
+#undef COMMON__UTF8_TOO_LARGE_1000
+#undef COMMON__UTF8_OVERLONG_4
+#undef COMMON__UTF8_TWO_CONTS
+#undef COMMON__UTF8_CARRY
+
+bool sv_utf8_validate(String_View strv)
+{
+    const unsigned char* s = (const unsigned char*)strv.data;
+    if(strv.count < 32) return common__utf8_validate_scalar(s, strv.count);
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+    for(; i + 32 <= strv.count; i += 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)(s + i));
+        if(_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+        } else {
+            error = _mm256_or_si256(error, common__utf8_check_block(input, prev_input));
+            prev_incomplete = common__utf8_incomplete(input);
         }
-        trace_log(TRACE_LOG_ERROR, "Could not create directory `%s`: `%s`", path, strerror(errno));
-        return false;
+        prev_input = input;
     }
-    return false;
+    if(i < strv.count) {
+        // Zero padding is ASCII, a truncated sequence at the end shows up as too short
+        unsigned char tail[32] = {0};
+        memcpy(tail, s + i, strv.count - i);
+        __m256i input = _mm256_loadu_si256((const __m256i*)tail);
+        error = _mm256_or_si256(error, common__utf8_check_block(input, prev_input));
+    } else {
+        error = _mm256_or_si256(error, prev_incomplete);
+    }
+    return _mm256_testz_si256(error, error);
 }
 
-bool copy_file(const char* dst_path, const char* src_path)
+size_t sv_utf8_count_codepoints(String_View strv)
 {
-    COMMON_ASSERT(0 && "Not implemented");
-    return false;
+    const unsigned char* s = (const unsigned char*)strv.data;
+    const __m256i last_cont = _mm256_set1_epi8((char)0xBF);
+    size_t count = 0;
+    size_t i = 0;
+    while(i + 32 <= strv.count) {
+        // Byte counters, folded before they can overflow
+        __m256i counters = _mm256_setzero_si256();
+        for(size_t block = 0; block < 255 && i + 32 <= strv.count; ++block, i += 32) {
+            __m256i input = _mm256_loadu_si256((const __m256i*)(s + i));
+            // Signed, continuation bytes are [-128, -65]
+            counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(input, last_cont));
+        }
+        __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+        count += (size_t)_mm256_extract_epi64(sums, 0) + (size_t)_mm256_extract_epi64(sums, 1)
+            + (size_t)_mm256_extract_epi64(sums, 2) + (size_t)_mm256_extract_epi64(sums, 3);
+    }
+    for(; i < strv.count; ++i) count += (s[i] & 0xC0) != 0x80;
+    return count;
 }
 
-bool copy_dir_recursive(const char* dst_path, const char* src_path)
+// The decoder is table-driven like simdutf's, keyed by where sequences end. A
+// byte ends one when the next byte is not a continuation, so the end-of-sequence
+// bits shifted by one mark the starts: the 8 start bits from a 4 byte chunk on
+// pick the pshufb row gathering the sequences starting in the chunk into 32-bit
+// lanes, last byte lowest. Every chunk is independent of the others. Generated.
+static const uint8_t common__utf8_gather[256][16] = {
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128 },
+    { 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128 },
+    { 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128 },
+    { 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 128, 128, 128, 128 },
+    { 6, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 6, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 6, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 6, 5, 4, 3, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 6, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 6, 5, 4, 3, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 6, 5, 4, 3, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 6, 5, 4, 3 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128 },
+    { 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 5, 4, 3, 2, 128, 128, 128, 128 },
+    { 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 5, 4, 3, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 4, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 4, 3, 2, 128, 128, 128, 128, 128 },
+    { 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 4, 3, 128, 128 },
+    { 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 0, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 3, 2, 1, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 3, 2, 128, 128, 128, 128, 128, 128 },
+    { 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 0, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 2, 1, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 0, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128, 128, 128, 128, 128 },
+    { 0, 128, 128, 128, 1, 128, 128, 128, 2, 128, 128, 128, 3, 128, 128, 128 },
+};
+static const uint8_t common__utf8_popcount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+static inline void common__utf8_widen16(uint32_t* dst, __m128i ascii)
 {
-    COMMON_ASSERT(0 && "Not implemented");
-    return false;
+    _mm256_storeu_si256((__m256i*)dst, _mm256_cvtepu8_epi32(ascii));
+    _mm256_storeu_si256((__m256i*)(dst + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(ascii, 8)));
 }
 
-bool read_dir(const char* parent, Path_List* children)
+// Bit k set when byte k of the 32 at `input` starts a sequence
+static inline uint64_t common__utf8_starts(__m256i input)
 {
-    bool result = true;
-    DIR *dir = NULL;
+    // Signed, continuation bytes are [-128, -65]
+    __m256i continuation = _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), input);
+    return ~(uint64_t)(uint32_t)_mm256_movemask_epi8(continuation) & 0xFFFFFFFF;
+}
 
-    dir = opendir(parent);
-    if (dir == NULL) {
-        trace_log(TRACE_LOG_ERROR, "Could not open directory %s: %s", parent, strerror(errno));
-        if (dir) closedir(dir);
-        return result;
+// Decodes the sequences starting in the 8 bytes at `s` as two 4 byte chunks,
+// keyed by their start bits and the 4 after. Stores 4 lanes past the last one.
+static inline uint32_t* common__utf8_decode8(const unsigned char* s, unsigned first_key, unsigned second_key, uint32_t* dst)
+{
+    // The bits a byte keeps by its high nibble: ASCII, continuation, 2, 3 and 4 byte leads
+    const __m256i payload = common__utf8_table(0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+            0x3F, 0x3F, 0x3F, 0x3F, 0x1F, 0x1F, 0x0F, 0x07);
+    // Both chunks gather from one load, the second one's row points 4 bytes on
+    const __m256i second_chunk = _mm256_setr_epi64x(0, 0, 0x0404040404040404, 0x0404040404040404);
+    __m256i in = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)s));
+    __m256i control = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)common__utf8_gather[first_key])),
+            _mm_loadu_si128((const __m128i*)common__utf8_gather[second_key]), 1);
+    __m256i bytes = _mm256_shuffle_epi8(in, _mm256_add_epi8(control, second_chunk));
+    __m256i nibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+    bytes = _mm256_and_si256(bytes, _mm256_shuffle_epi8(payload, nibbles));
+    // b0 | b1 << 6 in each half, then the halves 12 bits apart
+    __m256i halves = _mm256_maddubs_epi16(bytes, _mm256_set1_epi16(0x4001));
+    __m256i codepoints = _mm256_madd_epi16(halves, _mm256_set1_epi32(0x10000001));
+    _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(codepoints));
+    dst += common__utf8_popcount[first_key & 0xF];
+    _mm_storeu_si128((__m128i*)dst, _mm256_extracti128_si256(codepoints, 1));
+    return dst + common__utf8_popcount[second_key & 0xF];
+}
+
+// Decodes the sequences starting in the 32 bytes at `s`, `starts` covers them
+// and the next 8. Reads 40 bytes, only right for valid input.
+static inline uint32_t* common__utf8_decode32(const unsigned char* s, uint64_t starts, uint32_t* dst)
+{
+    dst = common__utf8_decode8(s +  0, (unsigned)starts & 0xFF, (unsigned)(starts >>  4) & 0xFF, dst);
+    dst = common__utf8_decode8(s +  8, (unsigned)(starts >>  8) & 0xFF, (unsigned)(starts >> 12) & 0xFF, dst);
+    dst = common__utf8_decode8(s + 16, (unsigned)(starts >> 16) & 0xFF, (unsigned)(starts >> 20) & 0xFF, dst);
+    return common__utf8_decode8(s + 24, (unsigned)(starts >> 24) & 0xFF, (unsigned)(starts >> 28) & 0xFF, dst);
+}
+
+#define COMMON__UTF8_STAGE 1024
+
+// Moves the `count` staged codepoints to `put` with non-temporal stores once
+// it is 32 byte aligned. Unless `all`, up to 7 stay staged so the next flush
+// starts aligned, the return is where they go.
+static uint32_t* common__utf8_flush(uint32_t* put, uint32_t* stage, size_t* count, bool all)
+{
+    size_t i = 0;
+    for(; i < *count && ((uintptr_t)(put + i) & 31) != 0; ++i) put[i] = stage[i];
+    for(; i + 8 <= *count; i += 8) {
+        _mm256_stream_si256((__m256i*)(put + i), _mm256_loadu_si256((const __m256i*)(stage + i)));
+    }
+    size_t left = *count - i;
+    if(all) {
+        for(; i < *count; ++i) put[i] = stage[i];
+        left = 0;
     }
+    memmove(stage, stage + i, left * sizeof(*stage));
+    *count = left;
+    return put + i;
+}
 
-    errno = 0;
-    struct dirent *ent = readdir(dir);
-    while (ent != NULL) {
-        da_append(children, nob_temp_strdup(ent->d_name));
-        ent = readdir(dir);
+#else
+
+bool sv_utf8_validate(String_View strv)
+{
+    return common__utf8_validate_scalar((const unsigned char*)strv.data, strv.count);
+}
+
+size_t sv_utf8_count_codepoints(String_View strv)
+{
+    const unsigned char* s = (const unsigned char*)strv.data;
+    size_t count = 0;
+    for(size_t i = 0; i < strv.count; ++i) count += (s[i] & 0xC0) != 0x80;
+    return count;
+}
+
+#endif // COMMON_SIMD_AVX2
+
+uint32_t sv_utf8_next(String_View* strv)
+{
+    COMMON_ASSERT(strv->count > 0);
+    const unsigned char* s = (const unsigned char*)strv->data;
+    uint32_t codepoint = s[0];
+    size_t length = 1;
+    if(codepoint >= 0x80) {
+        length = common__utf8_decode(s, strv->count, &codepoint);
+        if(length == 0) {
+            codepoint = SV_UTF8_REPLACEMENT;
+            length = 1;
+        }
     }
+    strv->data += length;
+    strv->count -= length;
+    return codepoint;
+}
 
-    if (errno != 0) {
-        trace_log(TRACE_LOG_ERROR, "Could not read directory %s: %s", parent, strerror(errno));
-        if (dir) closedir(dir);
-        return result;
+bool sv_utf8_to_utf32(String_View strv, Codepoints* out)
+{
+    // Never more codepoints than bytes, plus the lanes the SIMD path stores past the end
+    da_reserve(out, out->count + strv.count + 4);
+
+    // Decoded in place past `out->count`, which only moves once the input is known good
+    const unsigned char* s = (const unsigned char*)strv.data;
+    uint32_t* dst = out->data + out->count;
+    size_t i = 0;
+#if COMMON_SIMD_AVX2
+    // The checks of sv_utf8_validate() on each block while it is decoded. A block
+    // decodes the sequences starting in it, the 32 bytes after it give the
+    // start bits of the sequences running into them.
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    // Large outputs are decoded into a buffer that stays in L1 and leave it
+    // without the read-for-ownership of each line, which doubles their traffic
+    uint32_t stage[COMMON__UTF8_STAGE];
+    bool stream = strv.count >= COMMON_UTF8_STREAM_THRESHOLD;
+    uint32_t* put = dst;
+    if(stream) dst = stage;
+    for(; i + 96 <= strv.count; i += 64) {
+        __m256i first = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i second = _mm256_loadu_si256((const __m256i*)(s + i + 32));
+        if(_mm256_movemask_epi8(_mm256_or_si256(first, second)) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+            common__utf8_widen16(dst +  0, _mm256_castsi256_si128(first));
+            common__utf8_widen16(dst + 16, _mm256_extracti128_si256(first, 1));
+            common__utf8_widen16(dst + 32, _mm256_castsi256_si128(second));
+            common__utf8_widen16(dst + 48, _mm256_extracti128_si256(second, 1));
+            dst += 64;
+        } else {
+            error = _mm256_or_si256(error, common__utf8_check_block(first, prev_input));
+            error = _mm256_or_si256(error, common__utf8_check_block(second, first));
+            prev_incomplete = common__utf8_incomplete(second);
+            uint64_t first_starts = common__utf8_starts(first);
+            uint64_t second_starts = common__utf8_starts(second);
+            uint64_t next_starts = common__utf8_starts(_mm256_loadu_si256((const __m256i*)(s + i + 64)));
+            dst = common__utf8_decode32(s + i, first_starts | second_starts << 32, dst);
+            dst = common__utf8_decode32(s + i + 32, second_starts | next_starts << 32, dst);
+        }
+        prev_input = second;
+        // A block stores at most 68 lanes
+        if(stream && dst - stage > COMMON__UTF8_STAGE - 68) {
+            size_t count = (size_t)(dst - stage);
+            put = common__utf8_flush(put, stage, &count, false);
+            dst = stage + count;
+        }
+    }
+    if(stream) {
+        size_t count = (size_t)(dst - stage);
+        dst = common__utf8_flush(put, stage, &count, true);
+        _mm_sfence();
+    }
+    // The rest is only checked here and decoded one sequence at a time below
+    size_t rest = i;
+    for(; rest + 32 <= strv.count; rest += 32) {
+        __m256i input = _mm256_loadu_si256((const __m256i*)(s + rest));
+        error = _mm256_or_si256(error, common__utf8_check_block(input, prev_input));
+        prev_incomplete = common__utf8_incomplete(input);
+        prev_input = input;
+    }
+    if(rest < strv.count) {
+        unsigned char tail[32] = {0};
+        memcpy(tail, s + rest, strv.count - rest);
+        __m256i input = _mm256_loadu_si256((const __m256i*)tail);
+        error = _mm256_or_si256(error, common__utf8_check_block(input, prev_input));
+    } else {
+        error = _mm256_or_si256(error, prev_incomplete);
     }
+    if(!_mm256_testz_si256(error, error)) return false;
+    // Continuations of the last decoded sequence
+    while(i < strv.count && (s[i] & 0xC0) == 0x80) i += 1;
+#endif
+    while(i < strv.count) {
+        uint32_t codepoint;
+        size_t length = common__utf8_decode(s + i, strv.count - i, &codepoint);
+        if(length == 0) return false;
+        i += length;
+        *dst++ = codepoint;
+    }
+    out->count = (size_t)(dst - out->data);
+    return true;
+}
 
-    if (dir) closedir(dir);
-    return result;
+static inline unsigned char common__fold(unsigned char c)
+{
+    return c | (unsigned char)(((unsigned)(c - 'A') < 26) << 5);
 }
 
-bool load_file_data(const char* path, String_Builder* sb)
+#if COMMON_SIMD_SSE2
+static inline int common__ctz(unsigned x)
 {
+#if CC_MSVC
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctz(x);
+#endif
 }
 
-bool save_file_data(const char* path, const void* data, size_t size)
+static inline __m128i common__fold16(__m128i x)
+{
+    // Signed compare after biasing 'A' to -128 tests 'A' <= x <= 'Z'
+    __m128i biased = _mm_sub_epi8(x, _mm_set1_epi8((char)('A' + 128)));
+    __m128i is_upper = _mm_cmplt_epi8(biased, _mm_set1_epi8(-128 + 26));
+    return _mm_or_si128(x, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+static bool common__eq_ci(const unsigned char* a, const unsigned char* b, size_t n)
+{
+    size_t i = 0;
+#if COMMON_SIMD_SSE2
+    if(n >= 16) {
+        for(; i + 16 <= n; i += 16) {
+            __m128i x = common__fold16(_mm_loadu_si128((const __m128i*)(a + i)));
+            __m128i y = common__fold16(_mm_loadu_si128((const __m128i*)(b + i)));
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) return false;
+        }
+        if(i == n) return true;
+        // The last block overlaps the previous one
+        __m128i x = common__fold16(_mm_loadu_si128((const __m128i*)(a + n - 16)));
+        __m128i y = common__fold16(_mm_loadu_si128((const __m128i*)(b + n - 16)));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xFFFF;
+    }
+#endif
+    for(; i < n; ++i) {
+        if(common__fold(a[i]) != common__fold(b[i])) return false;
+    }
+    return true;
+}
+
+bool sv_eq_ci(String_View a, String_View b)
 {
+    if(a.count != b.count) return false;
+    return common__eq_ci((const unsigned char*)a.data, (const unsigned char*)b.data, a.count);
 }
 
+bool sv_has_prefix_ci(String_View strv, String_View prefix)
+{
+    if(strv.count < prefix.count) return false;
+    return common__eq_ci((const unsigned char*)strv.data, (const unsigned char*)prefix.data, prefix.count);
+}
+
+int sv_find_ci(String_View strv, String_View sth, size_t index)
+{
+    if(sth.count == 0 || strv.count < sth.count) return -1;
+
+    const unsigned char* s = (const unsigned char*)strv.data;
+    const unsigned char* needle = (const unsigned char*)sth.data;
+    size_t last = sth.count - 1;
+    size_t found_count = 0;
+    size_t i = 0;
+#if COMMON_SIMD_SSE2
+    const __m128i first_byte = _mm_set1_epi8((char)common__fold(needle[0]));
+    const __m128i last_byte = _mm_set1_epi8((char)common__fold(needle[last]));
+    for(; i + last + 16 <= strv.count; i += 16) {
+        __m128i firsts = common__fold16(_mm_loadu_si128((const __m128i*)(s + i)));
+        __m128i lasts = common__fold16(_mm_loadu_si128((const __m128i*)(s + i + last)));
+        unsigned candidates = (unsigned)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(firsts, first_byte), _mm_cmpeq_epi8(lasts, last_byte)));
+        while(candidates != 0) {
+            size_t at = i + (size_t)common__ctz(candidates);
+            candidates &= candidates - 1;
+            if(common__eq_ci(s + at, needle, sth.count)) {
+                if(found_count == index) return (int)at;
+                ++found_count;
+            }
+        }
+    }
+#endif
+    for(; i + last < strv.count; ++i) {
+        if(common__fold(s[i]) == common__fold(needle[0]) && common__eq_ci(s + i, needle, sth.count)) {
+            if(found_count == index) return (int)i;
+            ++found_count;
+        }
+    }
+    return -1;
+}
+
+// wyhash final version 4, 48 byte blocks over three independent lanes
+static const uint64_t common__wyp[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+static inline void common__wymum(uint64_t* a, uint64_t* b)
+{
+#if CC_MSVC
+    uint64_t hi;
+    *a = _umul128(*a, *b, &hi);
+    *b = hi;
+#else
+    __extension__ unsigned __int128 r = (unsigned __int128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#endif
+}
+
+static inline uint64_t common__wymix(uint64_t a, uint64_t b)
+{
+    common__wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t common__wyr8(const unsigned char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t common__wyr4(const unsigned char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void common__wyblock(Hash64* h, const unsigned char* p)
+{
+    h->seed = common__wymix(common__wyr8(p) ^ common__wyp[1], common__wyr8(p + 8) ^ h->seed);
+    h->see1 = common__wymix(common__wyr8(p + 16) ^ common__wyp[2], common__wyr8(p + 24) ^ h->see1);
+    h->see2 = common__wymix(common__wyr8(p + 32) ^ common__wyp[3], common__wyr8(p + 40) ^ h->see2);
+}
+
+// `p[-16, len)` must be readable when more than 16 bytes were hashed in total
+static uint64_t common__wyfinish(uint64_t seed, const unsigned char* p, size_t len, size_t total)
+{
+    uint64_t a, b;
+    if(total <= 16) {
+        if(len >= 4) {
+            a = (common__wyr4(p) << 32) | common__wyr4(p + ((len >> 3) << 2));
+            b = (common__wyr4(p + len - 4) << 32) | common__wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if(len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        while(len > 16) {
+            seed = common__wymix(common__wyr8(p) ^ common__wyp[1], common__wyr8(p + 8) ^ seed);
+            p += 16;
+            len -= 16;
+        }
+        a = common__wyr8(p + len - 16);
+        b = common__wyr8(p + len - 8);
+    }
+    a ^= common__wyp[1];
+    b ^= seed;
+    common__wymum(&a, &b);
+    return common__wymix(a ^ common__wyp[0] ^ total, b ^ common__wyp[1]);
+}
+
+uint64_t sv_hash64(String_View strv, uint64_t seed)
+{
+    const unsigned char* p = (const unsigned char*)strv.data;
+    size_t len = strv.count;
+    Hash64 h = { .seed = seed ^ common__wymix(seed ^ common__wyp[0], common__wyp[1]) };
+    if(len >= 48) {
+        h.see1 = h.see2 = h.seed;
+        do {
+            common__wyblock(&h, p);
+            p += 48;
+            len -= 48;
+        } while(len >= 48);
+        h.seed ^= h.see1 ^ h.see2;
+    }
+    return common__wyfinish(h.seed, p, len, strv.count);
+}
+
+void hash64_init(Hash64* h, uint64_t seed)
+{
+    memset(h, 0, sizeof(*h));
+    h->seed = h->see1 = h->see2 = seed ^ common__wymix(seed ^ common__wyp[0], common__wyp[1]);
+}
+
+// A full block is only mixed once more data follows it, like the one-shot loop does
+void hash64_update(Hash64* h, String_View data)
+{
+    const unsigned char* p = (const unsigned char*)data.data;
+    size_t n = data.count;
+    h->total += n;
+    while(n > 0) {
+        if(h->pending == 48) {
+            common__wyblock(h, h->buffer + 16);
+            memcpy(h->buffer, h->buffer + 48, 16);
+            h->pending = 0;
+        }
+        if(h->pending == 0 && n > 48) {
+            do {
+                common__wyblock(h, p);
+                p += 48;
+                n -= 48;
+            } while(n > 48);
+            memcpy(h->buffer, p - 16, 16);
+        }
+        size_t take = 48 - h->pending < n ? 48 - h->pending : n;
+        memcpy(h->buffer + 16 + h->pending, p, take);
+        h->pending += take;
+        p += take;
+        n -= take;
+    }
+}
+
+uint64_t hash64_final(const Hash64* h)
+{
+    Hash64 state = *h;
+    if(state.total >= 48) {
+        if(state.pending == 48) {
+            common__wyblock(&state, state.buffer + 16);
+            memcpy(state.buffer, state.buffer + 48, 16);
+            state.pending = 0;
+        }
+        state.seed ^= state.see1 ^ state.see2;
+    }
+    return common__wyfinish(state.seed, state.buffer + 16, state.pending, state.total);
+}
+
+#if !CC_MSVC
+
+static size_t queue__capacity(size_t capacity)
+{
+    size_t result = 2;
+    while(result < capacity) result <<= 1;
+    return result;
+}
+
+// Called by producers after publishing items, only touches the futex when a consumer sleeps
+static void queue__notify(Queue_Waiter* w)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&w->waiters, __ATOMIC_RELAXED) == 0) return;
+    __atomic_add_fetch(&w->word, 1, __ATOMIC_RELEASE);
+#if PLATFORM_LINUX && !defined(COMMON_PLATFORM_INDEPENDENT)
+    syscall(SYS_futex, &w->word, FUTEX_WAKE_PRIVATE, 0x7fffffff, NULL, NULL, 0);
+#endif
+}
+
+#define QUEUE_SPIN_COUNT 128
+
+// Blocks until `try_pop` succeeds. The waiter count is published before the
+// last attempt so a concurrent `queue__notify()` either sees it or we see the item.
+#define queue__pop_wait(w, try_pop)                                                 \
+    do {                                                                            \
+        bool queue__done = false;                                                   \
+        for(int spin = 0; spin < QUEUE_SPIN_COUNT && !queue__done; ++spin)          \
+            queue__done = (try_pop);                                                \
+        while(!queue__done) {                                                       \
+            __atomic_add_fetch(&(w)->waiters, 1, __ATOMIC_SEQ_CST);                 \
+            unsigned int queue__word = __atomic_load_n(&(w)->word, __ATOMIC_ACQUIRE);\
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);                                \
+            queue__done = (try_pop);                                                \
+            if(!queue__done) queue__sleep(&(w)->word, queue__word);                 \
+            __atomic_sub_fetch(&(w)->waiters, 1, __ATOMIC_RELAXED);                 \
+        }                                                                           \
+    } while(0)
+
+#if !PLATFORM_LINUX || defined(COMMON_PLATFORM_INDEPENDENT)
+static void queue__relax(void)
+{
+#if !defined(COMMON_PLATFORM_INDEPENDENT) && !PLATFORM_WINDOWS
+    sched_yield();
+#endif
+}
+#endif
+
+static void queue__sleep(unsigned int* word, unsigned int expected)
+{
+#if PLATFORM_LINUX && !defined(COMMON_PLATFORM_INDEPENDENT)
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    (void)word; (void)expected;
+    queue__relax();
+#endif
+}
+
+bool spsc_init(Spsc_Queue* q, size_t item_size, size_t capacity)
+{
+    memset(q, 0, sizeof(*q));
+    capacity = queue__capacity(capacity);
+    q->data = COMMON_MALLOC(capacity * item_size);
+    if(q->data == NULL) return false;
+    q->item_size = item_size;
+    q->mask = capacity - 1;
+    return true;
+}
+
+void spsc_deinit(Spsc_Queue* q)
+{
+    COMMON_FREE(q->data);
+    memset(q, 0, sizeof(*q));
+}
+
+size_t spsc_push_many(Spsc_Queue* q, const void* items, size_t count)
+{
+    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    size_t capacity = q->mask + 1;
+    if(capacity - (tail - q->cached_head) < count)
+        q->cached_head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    size_t space = capacity - (tail - q->cached_head);
+    if(count > space) count = space;
+    if(count == 0) return 0;
+
+    // At most two copies, one up to the end of the ring and one from its start
+    size_t index = tail & q->mask;
+    size_t first = capacity - index;
+    if(first > count) first = count;
+    memcpy(q->data + index * q->item_size, items, first * q->item_size);
+    memcpy(q->data, (const char*)items + first * q->item_size, (count - first) * q->item_size);
+
+    __atomic_store_n(&q->tail, tail + count, __ATOMIC_RELEASE);
+    queue__notify(&q->waiter);
+    return count;
+}
+
+size_t spsc_pop_many(Spsc_Queue* q, void* items, size_t count)
+{
+    size_t head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    if(q->cached_tail - head < count)
+        q->cached_tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    size_t available = q->cached_tail - head;
+    if(count > available) count = available;
+    if(count == 0) return 0;
+
+    size_t capacity = q->mask + 1;
+    size_t index = head & q->mask;
+    size_t first = capacity - index;
+    if(first > count) first = count;
+    memcpy(items, q->data + index * q->item_size, first * q->item_size);
+    memcpy((char*)items + first * q->item_size, q->data, (count - first) * q->item_size);
+
+    __atomic_store_n(&q->head, head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+bool spsc_push(Spsc_Queue* q, const void* item)
+{
+    return spsc_push_many(q, item, 1) == 1;
+}
+
+bool spsc_pop(Spsc_Queue* q, void* item)
+{
+    return spsc_pop_many(q, item, 1) == 1;
+}
+
+void spsc_pop_wait(Spsc_Queue* q, void* item)
+{
+    queue__pop_wait(&q->waiter, spsc_pop(q, item));
+}
+
+size_t spsc_pop_many_wait(Spsc_Queue* q, void* items, size_t count)
+{
+    size_t popped = 0;
+    if(count == 0) return 0;
+    queue__pop_wait(&q->waiter, (popped = spsc_pop_many(q, items, count)) > 0);
+    return popped;
+}
+
+#define MPMC_CELL(q, pos) ((size_t*)((q)->cells + ((pos) & (q)->mask) * (q)->cell_size))
+
+bool mpmc_init(Mpmc_Queue* q, size_t item_size, size_t capacity)
+{
+    memset(q, 0, sizeof(*q));
+    capacity = queue__capacity(capacity);
+    q->cell_size = (sizeof(size_t) + item_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    q->cells = COMMON_MALLOC(capacity * q->cell_size);
+    if(q->cells == NULL) return false;
+    q->item_size = item_size;
+    q->mask = capacity - 1;
+    for(size_t i = 0; i < capacity; ++i)
+        __atomic_store_n(MPMC_CELL(q, i), i, __ATOMIC_RELAXED);
+    return true;
+}
+
+void mpmc_deinit(Mpmc_Queue* q)
+{
+    COMMON_FREE(q->cells);
+    memset(q, 0, sizeof(*q));
+}
+
+// Count how many cells starting at `pos` are in the state `pos + offset` (at most `count`)
+static size_t mpmc__ready(Mpmc_Queue* q, size_t pos, size_t offset, size_t count)
+{
+    size_t n = 0;
+    while(n < count && n <= q->mask) {
+        size_t seq = __atomic_load_n(MPMC_CELL(q, pos + n), __ATOMIC_ACQUIRE);
+        if(seq != pos + n + offset) break;
+        ++n;
+    }
+    return n;
+}
+
+size_t mpmc_push_many(Mpmc_Queue* q, const void* items, size_t count)
+{
+    size_t pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+    size_t n;
+    for(;;) {
+        n = mpmc__ready(q, pos, 0, count);
+        if(n == 0) {
+            // Either full or another producer moved on, reload and decide
+            size_t seq = __atomic_load_n(MPMC_CELL(q, pos), __ATOMIC_ACQUIRE);
+            if((ptrdiff_t)(seq - pos) < 0) return 0;
+            pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+        if(__atomic_compare_exchange_n(&q->enqueue_pos, &pos, pos + n, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+
+    for(size_t i = 0; i < n; ++i) {
+        size_t* cell = MPMC_CELL(q, pos + i);
+        memcpy(cell + 1, (const char*)items + i * q->item_size, q->item_size);
+        __atomic_store_n(cell, pos + i + 1, __ATOMIC_RELEASE);
+    }
+    queue__notify(&q->waiter);
+    return n;
+}
+
+size_t mpmc_pop_many(Mpmc_Queue* q, void* items, size_t count)
+{
+    size_t pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+    size_t n;
+    for(;;) {
+        n = mpmc__ready(q, pos, 1, count);
+        if(n == 0) {
+            size_t seq = __atomic_load_n(MPMC_CELL(q, pos), __ATOMIC_ACQUIRE);
+            if((ptrdiff_t)(seq - (pos + 1)) < 0) return 0;
+            pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+            continue;
+        }
+        if(__atomic_compare_exchange_n(&q->dequeue_pos, &pos, pos + n, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+
+    for(size_t i = 0; i < n; ++i) {
+        size_t* cell = MPMC_CELL(q, pos + i);
+        memcpy((char*)items + i * q->item_size, cell + 1, q->item_size);
+        __atomic_store_n(cell, pos + i + q->mask + 1, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+bool mpmc_push(Mpmc_Queue* q, const void* item)
+{
+    return mpmc_push_many(q, item, 1) == 1;
+}
+
+bool mpmc_pop(Mpmc_Queue* q, void* item)
+{
+    return mpmc_pop_many(q, item, 1) == 1;
+}
+
+void mpmc_pop_wait(Mpmc_Queue* q, void* item)
+{
+    queue__pop_wait(&q->waiter, mpmc_pop(q, item));
+}
+
+size_t mpmc_pop_many_wait(Mpmc_Queue* q, void* items, size_t count)
+{
+    size_t popped = 0;
+    if(count == 0) return 0;
+    queue__pop_wait(&q->waiter, (popped = mpmc_pop_many(q, items, count)) > 0);
+    return popped;
+}
+
+#endif // !CC_MSVC
+
+#ifdef COMMON_TRACK_ALLOCS
+
+#include <stdlib.h> // qsort
+
+typedef struct {
+    unsigned long long key;     // 0 while free
+    int ready;                  // file and line are written
+    Common_Alloc_Site site;
+} Common__Alloc_Slot;
+
+// Keeps the user pointer as aligned as the raw allocator made the block
+typedef union {
+    struct {
+        size_t size;
+        size_t site;
+    };
+    long double align;
+} Common__Alloc_Header;
+
+static Common__Alloc_Slot common__alloc_slots[COMMON_TRACK_MAX_SITES + 1];
+
+static size_t common__alloc_site(const char* file, int line)
+{
+    unsigned long long hash = (unsigned long long)(size_t)file * 0x9E3779B97F4A7C15ull
+        ^ (unsigned long long)line * 0xC2B2AE3D27D4EB4Full;
+    unsigned long long key = hash | 1;
+    for(size_t probe = 0; probe < COMMON_TRACK_MAX_SITES; ++probe) {
+        size_t i = (size_t)(hash + probe) & (COMMON_TRACK_MAX_SITES - 1);
+        Common__Alloc_Slot* slot = &common__alloc_slots[i];
+        unsigned long long current = __atomic_load_n(&slot->key, __ATOMIC_ACQUIRE);
+        if(current == 0) {
+            if(__atomic_compare_exchange_n(&slot->key, &current, key, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                slot->site.file = file;
+                slot->site.line = line;
+                __atomic_store_n(&slot->ready, 1, __ATOMIC_RELEASE);
+                return i;
+            }
+        }
+        if(current == key) {
+            // Claimed by another thread a moment ago
+            while(!__atomic_load_n(&slot->ready, __ATOMIC_ACQUIRE)) {}
+            if(slot->site.file == file && slot->site.line == line) return i;
+        }
+    }
+    Common__Alloc_Slot* other = &common__alloc_slots[COMMON_TRACK_MAX_SITES];
+    other->site.file = "<other>";
+    __atomic_store_n(&other->ready, 1, __ATOMIC_RELEASE);
+    return COMMON_TRACK_MAX_SITES;
+}
+
+#define common__alloc_add(index, field, n) \
+    __atomic_fetch_add(&common__alloc_slots[index].site.field, (n), __ATOMIC_RELAXED)
+#define common__alloc_sub(index, field, n) \
+    __atomic_fetch_sub(&common__alloc_slots[index].site.field, (n), __ATOMIC_RELAXED)
+
+void* common__track_malloc(size_t size, const char* file, int line)
+{
+    Common__Alloc_Header* h = common__raw_malloc(sizeof(*h) + size);
+    if(h == NULL) return NULL;
+    h->size = size;
+    h->site = common__alloc_site(file, line);
+    common__alloc_add(h->site, count, 1);
+    common__alloc_add(h->site, bytes, size);
+    common__alloc_add(h->site, live_bytes, size);
+    return h + 1;
+}
+
+void* common__track_realloc(void* ptr, size_t size, const char* file, int line)
+{
+    if(ptr == NULL) return common__track_malloc(size, file, line);
+
+    Common__Alloc_Header* old = (Common__Alloc_Header*)ptr - 1;
+    size_t old_size = old->size;
+    size_t old_site = old->site;
+    Common__Alloc_Header* h = common__raw_realloc(old, sizeof(*h) + size);
+    if(h == NULL) return NULL;
+
+    size_t site = common__alloc_site(file, line);
+    common__alloc_sub(old_site, live_bytes, old_size);
+    common__alloc_add(site, live_bytes, size);
+    common__alloc_add(site, count, 1);
+    common__alloc_add(site, bytes, size);
+    if(h != old) {
+        common__alloc_add(site, realloc_copies, 1);
+        common__alloc_add(site, realloc_copy_bytes, old_size < size ? old_size : size);
+    }
+    h->size = size;
+    h->site = site;
+    return h + 1;
+}
+
+void common__track_free(void* ptr)
+{
+    if(ptr == NULL) return;
+    Common__Alloc_Header* h = (Common__Alloc_Header*)ptr - 1;
+    common__alloc_sub(h->site, live_bytes, h->size);
+    common__alloc_add(h->site, frees, 1);
+    common__raw_free(h);
+}
+
+static int common__alloc_site_compare(const void* a, const void* b)
+{
+    const Common_Alloc_Site* x = a;
+    const Common_Alloc_Site* y = b;
+    if(x->realloc_copy_bytes != y->realloc_copy_bytes) return x->realloc_copy_bytes < y->realloc_copy_bytes ? 1 : -1;
+    if(x->bytes != y->bytes) return x->bytes < y->bytes ? 1 : -1;
+    return 0;
+}
+
+size_t common_alloc_sites(Common_Alloc_Site* sites, size_t max_sites)
+{
+    // Gather everything first so the sort sees the heaviest sites
+    Common_Alloc_Site* all = common__raw_malloc((COMMON_TRACK_MAX_SITES + 1) * sizeof(*all));
+    if(all == NULL) return 0;
+    size_t count = 0;
+    for(size_t i = 0; i <= COMMON_TRACK_MAX_SITES; ++i) {
+        Common__Alloc_Slot* slot = &common__alloc_slots[i];
+        if(!__atomic_load_n(&slot->ready, __ATOMIC_ACQUIRE)) continue;
+        Common_Alloc_Site* site = &all[count++];
+        site->file = slot->site.file;
+        site->line = slot->site.line;
+        site->count = __atomic_load_n(&slot->site.count, __ATOMIC_RELAXED);
+        site->bytes = __atomic_load_n(&slot->site.bytes, __ATOMIC_RELAXED);
+        site->live_bytes = __atomic_load_n(&slot->site.live_bytes, __ATOMIC_RELAXED);
+        site->frees = __atomic_load_n(&slot->site.frees, __ATOMIC_RELAXED);
+        site->realloc_copies = __atomic_load_n(&slot->site.realloc_copies, __ATOMIC_RELAXED);
+        site->realloc_copy_bytes = __atomic_load_n(&slot->site.realloc_copy_bytes, __ATOMIC_RELAXED);
+    }
+    qsort(all, count, sizeof(*all), common__alloc_site_compare);
+    if(count > max_sites) count = max_sites;
+    __common_memcpy(sites, all, count * sizeof(*all));
+    common__raw_free(all);
+    return count;
+}
+
+void common_alloc_report(size_t max_sites)
+{
+    Common_Alloc_Site* sites = common__raw_malloc(max_sites * sizeof(*sites));
+    if(sites == NULL) return;
+    size_t count = common_alloc_sites(sites, max_sites);
+    trace_log(TRACE_LOG_INFO, "Allocations by site (%zu shown):", count);
+    for(size_t i = 0; i < count; ++i) {
+        Common_Alloc_Site* s = &sites[i];
+        trace_log(TRACE_LOG_INFO, "  %s:%d: %zu calls, %zu bytes, %zu live, %zu frees, %zu realloc copies (%zu bytes)",
+                s->file, s->line, s->count, s->bytes, s->live_bytes, s->frees, s->realloc_copies, s->realloc_copy_bytes);
+    }
+    common__raw_free(sites);
+}
+
+#endif // COMMON_TRACK_ALLOCS
+
+void trace_log(Trace_Log_Level level, const char* fmt, ...)
+{
+    FILE* f = level <= TRACE_LOG_WARN ? stdout : stderr;
+    switch(level) {
+        case TRACE_LOG_INFO: fprintf(f, "[INFO] "); break;
+        case TRACE_LOG_WARN: fprintf(f, "[WARN] "); break;
+        case TRACE_LOG_ERROR: fprintf(f, "[ERROR] "); break;
+        case TRACE_LOG_FATAL: fprintf(f, "[FATAL] "); break;
+    }
+
+    va_list arg;
+    va_start(arg, fmt);
+    vfprintf(f, fmt, arg);
+    va_end(arg);
+    fprintf(f, "\n");
+}
+
+#ifndef COMMON_PLATFORM_INDEPENDENT
+
+bool mkdir_if_not_exists(const char* path)
+{
+#if PLATFORM_WINDOWS
+    int result = mkdir(path);
+#else
+    int result = mkdir(path, 0755);
+#endif
+    if(result < 0) {
+        if(errno == EEXIST) {
+            trace_log(TRACE_LOG_WARN, "Directory `%s` already exists", path);
+            return true;
+        }
+        trace_log(TRACE_LOG_ERROR, "Could not create directory `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+    return false;
+}
+
+#if PLATFORM_WINDOWS
+bool copy_file(const char* dst_path, const char* src_path)
+{
+    COMMON_ASSERT(0 && "Not implemented");
+    return false;
+}
+
+bool copy_dir_recursive(const char* dst_path, const char* src_path)
+{
+    COMMON_ASSERT(0 && "Not implemented");
+    return false;
+}
+#endif
+
+bool read_dir(const char* parent, Path_List* children)
+{
+    bool result = true;
+    DIR *dir = NULL;
+
+    dir = opendir(parent);
+    if (dir == NULL) {
+        trace_log(TRACE_LOG_ERROR, "Could not open directory %s: %s", parent, strerror(errno));
+        return false;
+    }
+
+    errno = 0;
+    struct dirent *ent = readdir(dir);
+    while (ent != NULL) {
+        size_t name_length = strlen(ent->d_name);
+        char* name = COMMON_MALLOC(name_length + 1);
+        memcpy(name, ent->d_name, name_length + 1);
+        da_append(children, sv_from_parts(name, name_length));
+        ent = readdir(dir);
+    }
+
+    if (errno != 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not read directory %s: %s", parent, strerror(errno));
+        result = false;
+    }
+
+    if (dir) closedir(dir);
+    return result;
+}
+
+bool load_file_data(const char* path, String_Builder* sb)
+{
+    FILE* f = fopen(path, "rb");
+    if(f == NULL) {
+        trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+
+    bool result = false;
+    if(fseek(f, 0, SEEK_END) < 0) goto defer;
+    long size = ftell(f);
+    if(size < 0) goto defer;
+    if(fseek(f, 0, SEEK_SET) < 0) goto defer;
+
+    da_reserve(sb, sb->count + size);
+    if(fread(sb->data + sb->count, 1, size, f) != (size_t)size) goto defer;
+    sb->count += size;
+    result = true;
+
+defer:
+    if(!result) trace_log(TRACE_LOG_ERROR, "Could not read file `%s`: `%s`", path, strerror(errno));
+    fclose(f);
+    return result;
+}
+
+bool save_file_data(const char* path, const void* data, size_t size)
+{
+    FILE* f = fopen(path, "wb");
+    if(f == NULL) {
+        trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+
+    bool result = fwrite(data, 1, size, f) == size;
+    if(!result) trace_log(TRACE_LOG_ERROR, "Could not write file `%s`: `%s`", path, strerror(errno));
+    fclose(f);
+    return result;
+}
+
+#if !PLATFORM_WINDOWS
+
+extern char** environ;
+
+static double common__now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int common__exit_code(int status)
+{
+    if(WIFEXITED(status)) return WEXITSTATUS(status);
+    if(WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return -1;
+}
+
+Proc cmd_run_async(const Cmd* cmd)
+{
+    if(cmd->count == 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not run an empty command");
+        return INVALID_PROC;
+    }
+
+    char** argv = COMMON_MALLOC((cmd->count + 1) * sizeof(*argv));
+    memcpy(argv, cmd->data, cmd->count * sizeof(*argv));
+    argv[cmd->count] = NULL;
+    pid_t pid;
+    int error = posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ);
+    COMMON_FREE(argv);
+    if(error != 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not run `%s`: `%s`", cmd->data[0], strerror(error));
+        return INVALID_PROC;
+    }
+    return pid;
+}
+
+bool proc_wait(Proc proc, int* exit_code)
+{
+    int status;
+    while(waitpid(proc, &status, 0) < 0) {
+        if(errno != EINTR) {
+            trace_log(TRACE_LOG_ERROR, "Could not wait for process %d: `%s`", proc, strerror(errno));
+            return false;
+        }
+    }
+    int code = common__exit_code(status);
+    if(exit_code) *exit_code = code;
+    return code == 0;
+}
+
+bool cmd_run_sync(const Cmd* cmd)
+{
+    Proc proc = cmd_run_async(cmd);
+    if(proc == INVALID_PROC) return false;
+    return proc_wait(proc, NULL);
+}
+
+void procs_init(Procs* ps, size_t max_jobs)
+{
+    memset(ps, 0, sizeof(*ps));
+    if(max_jobs == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        max_jobs = online > 0 ? (size_t)online : 1;
+    }
+    ps->max_jobs = max_jobs;
+}
+
+static void procs__finish(Procs* ps, size_t slot, int exit_code)
+{
+    Procs_Slot* s = &ps->running.data[slot];
+    Proc_Result result = {
+        .index = s->index,
+        .proc = s->proc,
+        .exit_code = exit_code,
+        .ok = exit_code == 0,
+        .wall_seconds = common__now_seconds() - s->start,
+    };
+    da_append(&ps->results, result);
+    if(s->pidfd >= 0) close(s->pidfd);
+    da_remove_swap(&ps->running, slot);
+}
+
+// Reaps every child that already finished, true if there was one
+static bool procs__collect(Procs* ps)
+{
+    bool reaped = false;
+    for(size_t i = 0; i < ps->running.count;) {
+        int status;
+        pid_t pid = waitpid(ps->running.data[i].proc, &status, WNOHANG);
+        if(pid == ps->running.data[i].proc || (pid < 0 && errno != EINTR)) {
+            procs__finish(ps, i, pid < 0 ? -1 : common__exit_code(status));
+            reaped = true;
+        } else {
+            ++i;
+        }
+    }
+    return reaped;
+}
+
+// Blocks until at least one child finished and reaps it
+static void procs__reap(Procs* ps)
+{
+    while(!procs__collect(ps) && ps->running.count > 0) {
+        bool all_pidfds = true;
+        for(size_t i = 0; i < ps->running.count; ++i) all_pidfds = all_pidfds && ps->running.data[i].pidfd >= 0;
+
+        // A pidfd is readable once its process exited, even before the poll started
+        if(all_pidfds) {
+            struct pollfd* fds = COMMON_MALLOC(ps->running.count * sizeof(*fds));
+            for(size_t i = 0; i < ps->running.count; ++i) {
+                fds[i] = (struct pollfd){ .fd = ps->running.data[i].pidfd, .events = POLLIN };
+            }
+            poll(fds, ps->running.count, -1);
+            COMMON_FREE(fds);
+        } else {
+            struct timespec pause = { .tv_sec = 0, .tv_nsec = 1000000 };
+            nanosleep(&pause, NULL);
+        }
+    }
+}
+
+bool procs_run(Procs* ps, const Cmd* cmd)
+{
+    procs__collect(ps);
+    while(ps->running.count >= ps->max_jobs) procs__reap(ps);
+
+    size_t index = ps->submitted++;
+    double start = common__now_seconds();
+    Proc proc = cmd_run_async(cmd);
+    if(proc == INVALID_PROC) {
+        Proc_Result result = { .index = index, .proc = INVALID_PROC, .exit_code = 127 };
+        da_append(&ps->results, result);
+        return false;
+    }
+
+    int pidfd = -1;
+#if PLATFORM_LINUX && defined(SYS_pidfd_open)
+    pidfd = (int)syscall(SYS_pidfd_open, proc, 0);
+#endif
+    Procs_Slot slot = { .proc = proc, .pidfd = pidfd, .index = index, .start = start };
+    da_append(&ps->running, slot);
+    return true;
+}
+
+bool procs_wait_all(Procs* ps)
+{
+    while(ps->running.count > 0) procs__reap(ps);
+    for(size_t i = 0; i < ps->results.count; ++i) {
+        if(!ps->results.data[i].ok) return false;
+    }
+    return true;
+}
+
+void procs_free(Procs* ps)
+{
+    procs_wait_all(ps);
+    da_free(&ps->running);
+    da_free(&ps->results);
+    memset(ps, 0, sizeof(*ps));
+}
+
+// Incremental builds
+
+#ifndef FILE_HASH_MAX_THREADS
+    #define FILE_HASH_MAX_THREADS 64
+#endif
+#define FILE_HASH_READ_SIZE (256*1024)
+#define BUILD_CACHE_MAGIC "build-cache 1"
+
+static int64_t common__mtime_ns(const struct stat* st)
+{
+#if PLATFORM_APPLE
+    return (int64_t)st->st_mtimespec.tv_sec * 1000000000 + st->st_mtimespec.tv_nsec;
+#else
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+typedef struct {
+    const char* path;
+    uint64_t size;
+    size_t first_chunk;
+    size_t chunk_count;
+    int failed;
+} Common__Hash_File;
+
+typedef struct {
+    Common__Hash_File* files;
+    size_t* chunk_files;    // file of every chunk
+    uint64_t* chunk_hashes;
+    size_t chunk_count;
+    size_t next_chunk;      // claimed with __atomic_fetch_add
+} Common__Hash_Batch;
+
+static void* common__hash_worker(void* arg)
+{
+    Common__Hash_Batch* batch = arg;
+    char* buffer = COMMON_MALLOC(FILE_HASH_READ_SIZE);
+    int fd = -1;
+    size_t fd_file = (size_t)-1;
+    for(;;) {
+        size_t chunk = __atomic_fetch_add(&batch->next_chunk, 1, __ATOMIC_RELAXED);
+        if(chunk >= batch->chunk_count) break;
+
+        // Chunks of one file are claimed in order, so the descriptor is mostly reused
+        size_t file_index = batch->chunk_files[chunk];
+        Common__Hash_File* file = &batch->files[file_index];
+        if(file_index != fd_file) {
+            if(fd >= 0) close(fd);
+            fd = open(file->path, O_RDONLY);
+            fd_file = file_index;
+        }
+
+        size_t chunk_index = chunk - file->first_chunk;
+        uint64_t offset = (uint64_t)chunk_index * FILE_HASH_CHUNK_SIZE;
+        uint64_t end = offset + FILE_HASH_CHUNK_SIZE < file->size ? offset + FILE_HASH_CHUNK_SIZE : file->size;
+        Hash64 h;
+        hash64_init(&h, chunk_index);
+        bool ok = fd >= 0;
+        while(ok && offset < end) {
+            size_t want = end - offset < FILE_HASH_READ_SIZE ? (size_t)(end - offset) : FILE_HASH_READ_SIZE;
+            ssize_t n = pread(fd, buffer, want, (off_t)offset);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) ok = false; // truncated while hashing
+            else {
+                hash64_update(&h, sv_from_parts(buffer, (size_t)n));
+                offset += (uint64_t)n;
+            }
+        }
+        if(!ok) __atomic_store_n(&file->failed, 1, __ATOMIC_RELAXED);
+        batch->chunk_hashes[chunk] = hash64_final(&h);
+    }
+    if(fd >= 0) close(fd);
+    COMMON_FREE(buffer);
+    return NULL;
+}
+
+// Hashes every chunk of every file on one pool, many small files spread as well as one large file
+static void common__hash_files(Common__Hash_File* files, size_t file_count, uint64_t* hashes)
+{
+    Common__Hash_Batch batch = { .files = files };
+    for(size_t i = 0; i < file_count; ++i) {
+        files[i].first_chunk = batch.chunk_count;
+        files[i].chunk_count = files[i].size == 0 ? 1 : (size_t)((files[i].size + FILE_HASH_CHUNK_SIZE - 1) / FILE_HASH_CHUNK_SIZE);
+        files[i].failed = 0;
+        batch.chunk_count += files[i].chunk_count;
+    }
+    if(batch.chunk_count == 0) return;
+    batch.chunk_files = COMMON_MALLOC(batch.chunk_count * sizeof(*batch.chunk_files));
+    batch.chunk_hashes = COMMON_MALLOC(batch.chunk_count * sizeof(*batch.chunk_hashes));
+    for(size_t i = 0; i < file_count; ++i) {
+        for(size_t c = 0; c < files[i].chunk_count; ++c) batch.chunk_files[files[i].first_chunk + c] = i;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = online > 0 ? (size_t)online : 1;
+    if(thread_count > batch.chunk_count) thread_count = batch.chunk_count;
+    if(thread_count > FILE_HASH_MAX_THREADS) thread_count = FILE_HASH_MAX_THREADS;
+
+    // The calling thread works too
+    pthread_t threads[FILE_HASH_MAX_THREADS];
+    size_t spawned = 0;
+    for(size_t t = 1; t < thread_count; ++t) {
+        if(pthread_create(&threads[spawned], NULL, common__hash_worker, &batch) == 0) spawned += 1;
+    }
+    common__hash_worker(&batch);
+    for(size_t t = 0; t < spawned; ++t) pthread_join(threads[t], NULL);
+
+    for(size_t i = 0; i < file_count; ++i) {
+        String_View chunk_hashes = sv_from_parts((const char*)(batch.chunk_hashes + files[i].first_chunk),
+                files[i].chunk_count * sizeof(uint64_t));
+        hashes[i] = sv_hash64(chunk_hashes, files[i].size);
+    }
+    COMMON_FREE(batch.chunk_files);
+    COMMON_FREE(batch.chunk_hashes);
+}
+
+bool file_hash64(const char* path, uint64_t* hash)
+{
+    struct stat st;
+    if(stat(path, &st) < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not stat file `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+    Common__Hash_File file = { .path = path, .size = (uint64_t)st.st_size };
+    common__hash_files(&file, 1, hash);
+    if(file.failed) trace_log(TRACE_LOG_ERROR, "Could not read file `%s`", path);
+    return !file.failed;
+}
+
+static Build_Cache* common__build_cache = NULL;
+
+static size_t build_cache__slot(const Build_Cache* cache, const char* path)
+{
+    size_t mask = cache->slot_count - 1;
+    size_t i = (size_t)sv_hash64(sv_from_cstr(path), 0) & mask;
+    while(cache->slots[i] != 0 && strcmp(cache->entries.data[cache->slots[i] - 1].path, path) != 0) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static void build_cache__grow(Build_Cache* cache)
+{
+    COMMON_FREE(cache->slots);
+    cache->slot_count = cache->slot_count == 0 ? 64 : cache->slot_count * 2;
+    cache->slots = COMMON_MALLOC(cache->slot_count * sizeof(*cache->slots));
+    memset(cache->slots, 0, cache->slot_count * sizeof(*cache->slots));
+    for(size_t i = 0; i < cache->entries.count; ++i) {
+        cache->slots[build_cache__slot(cache, cache->entries.data[i].path)] = (uint32_t)(i + 1);
+    }
+}
+
+static Build_Cache_Entry* build_cache__get(Build_Cache* cache, const char* path)
+{
+    if((cache->entries.count + 1) * 2 > cache->slot_count) build_cache__grow(cache);
+    size_t slot = build_cache__slot(cache, path);
+    if(cache->slots[slot] == 0) {
+        size_t length = strlen(path);
+        Build_Cache_Entry entry = {0};
+        entry.path = COMMON_MALLOC(length + 1);
+        memcpy(entry.path, path, length + 1);
+        da_append(&cache->entries, entry);
+        cache->slots[slot] = (uint32_t)cache->entries.count;
+        cache->changed = true;
+    }
+    return &cache->entries.data[cache->slots[slot] - 1];
+}
+
+// Everything known about a file is dropped once its size or mtime changed
+static void build_cache__stamp(Build_Cache* cache, Build_Cache_Entry* entry, const struct stat* st)
+{
+    if(entry->size == (uint64_t)st->st_size && entry->mtime_ns == common__mtime_ns(st)) return;
+    entry->size = (uint64_t)st->st_size;
+    entry->mtime_ns = common__mtime_ns(st);
+    entry->hash = 0;
+    entry->inputs_hash = 0;
+    cache->changed = true;
+}
+
+// Content hashes of already stat'ed files, only files missing from the cache are read
+static bool common__content_hashes(const char** paths, const struct stat* sts, size_t count, uint64_t* hashes)
+{
+    Build_Cache* cache = common__build_cache;
+    da(Common__Hash_File) todo = {0};
+    da(size_t) todo_indices = {0};
+    for(size_t i = 0; i < count; ++i) {
+        if(cache != NULL) {
+            Build_Cache_Entry* entry = build_cache__get(cache, paths[i]);
+            build_cache__stamp(cache, entry, &sts[i]);
+            if(entry->hash != 0) {
+                hashes[i] = entry->hash;
+                continue;
+            }
+        }
+        Common__Hash_File file = { .path = paths[i], .size = (uint64_t)sts[i].st_size };
+        da_append(&todo, file);
+        da_append(&todo_indices, i);
+    }
+
+    bool result = true;
+    if(todo.count > 0) {
+        uint64_t* todo_hashes = COMMON_MALLOC(todo.count * sizeof(*todo_hashes));
+        common__hash_files(todo.data, todo.count, todo_hashes);
+        for(size_t t = 0; t < todo.count; ++t) {
+            if(todo.data[t].failed) {
+                trace_log(TRACE_LOG_ERROR, "Could not read file `%s`", todo.data[t].path);
+                result = false;
+                continue;
+            }
+            hashes[todo_indices.data[t]] = todo_hashes[t];
+            if(cache != NULL) {
+                build_cache__get(cache, todo.data[t].path)->hash = todo_hashes[t];
+                cache->changed = true;
+            }
+        }
+        COMMON_FREE(todo_hashes);
+    }
+    da_free(&todo);
+    da_free(&todo_indices);
+    return result;
+}
+
+bool build_cache_open(Build_Cache* cache, const char* index_path)
+{
+    memset(cache, 0, sizeof(*cache));
+    size_t length = strlen(index_path);
+    cache->index_path = COMMON_MALLOC(length + 1);
+    memcpy(cache->index_path, index_path, length + 1);
+
+    struct stat st;
+    if(stat(index_path, &st) < 0) {
+        if(errno == ENOENT) {
+            common__build_cache = cache;
+            return true;
+        }
+        trace_log(TRACE_LOG_ERROR, "Could not stat build cache `%s`: `%s`", index_path, strerror(errno));
+        goto fail;
+    }
+    String_Builder sb = {0};
+    if(!load_file_data(index_path, &sb)) {
+        sb_free(&sb);
+        goto fail;
+    }
+    da_append(&sb, '\0');
+
+    // One line per path: hash inputs_hash size mtime_ns path
+    char* line = sb.data;
+    char* newline = strchr(line, '\n');
+    bool result = newline != NULL && (size_t)(newline - line) == strlen(BUILD_CACHE_MAGIC) &&
+            memcmp(line, BUILD_CACHE_MAGIC, strlen(BUILD_CACHE_MAGIC)) == 0;
+    if(!result) trace_log(TRACE_LOG_WARN, "Ignoring build cache `%s` with an unknown format", index_path);
+    while(result && (line = newline + 1) < sb.data + sb.count - 1) {
+        newline = strchr(line, '\n');
+        if(newline == NULL) break;
+        *newline = '\0';
+
+        uint64_t hash, inputs_hash, size;
+        int64_t mtime_ns;
+        int path_start = 0;
+        if(sscanf(line, "%" SCNx64 " %" SCNx64 " %" SCNu64 " %" SCNd64 " %n",
+                    &hash, &inputs_hash, &size, &mtime_ns, &path_start) != 4 || path_start == 0) {
+            trace_log(TRACE_LOG_WARN, "Skipping malformed line in build cache `%s`", index_path);
+            continue;
+        }
+        Build_Cache_Entry* entry = build_cache__get(cache, line + path_start);
+        entry->hash = hash;
+        entry->inputs_hash = inputs_hash;
+        entry->size = size;
+        entry->mtime_ns = mtime_ns;
+    }
+    cache->changed = false;
+    sb_free(&sb);
+    common__build_cache = cache;
+    return true;
+
+fail:
+    COMMON_FREE(cache->index_path);
+    memset(cache, 0, sizeof(*cache));
+    return false;
+}
+
+bool build_cache_close(Build_Cache* cache)
+{
+    bool result = true;
+    if(cache->changed) {
+        // Written next to the index and renamed over it, an interrupted run keeps the old one
+        size_t length = strlen(cache->index_path);
+        char* tmp_path = COMMON_MALLOC(length + 5);
+        memcpy(tmp_path, cache->index_path, length);
+        memcpy(tmp_path + length, ".tmp", 5);
+        FILE* f = fopen(tmp_path, "wb");
+        if(f == NULL) {
+            trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", tmp_path, strerror(errno));
+            result = false;
+        } else {
+            fprintf(f, BUILD_CACHE_MAGIC "\n");
+            for(size_t i = 0; i < cache->entries.count; ++i) {
+                const Build_Cache_Entry* e = &cache->entries.data[i];
+                fprintf(f, "%016" PRIx64 " %016" PRIx64 " %" PRIu64 " %" PRId64 " %s\n",
+                        e->hash, e->inputs_hash, e->size, e->mtime_ns, e->path);
+            }
+            result = fclose(f) == 0 && rename(tmp_path, cache->index_path) == 0;
+            if(!result) trace_log(TRACE_LOG_ERROR, "Could not write build cache `%s`: `%s`", cache->index_path, strerror(errno));
+        }
+        COMMON_FREE(tmp_path);
+    }
+
+    for(size_t i = 0; i < cache->entries.count; ++i) COMMON_FREE(cache->entries.data[i].path);
+    da_free(&cache->entries);
+    COMMON_FREE(cache->slots);
+    COMMON_FREE(cache->index_path);
+    if(common__build_cache == cache) common__build_cache = NULL;
+    memset(cache, 0, sizeof(*cache));
+    return result;
+}
+
+bool needs_rebuild(const char* output, const char** inputs, size_t input_count)
+{
+    struct stat output_st;
+    if(stat(output, &output_st) < 0) return true;
+
+    // Every input is stat'ed before anything is hashed, without a cache the mtimes decide
+    struct stat* sts = COMMON_MALLOC((input_count > 0 ? input_count : 1) * sizeof(*sts));
+    uint64_t* hashes = NULL;
+    bool result = true;
+    bool stale = false;
+    for(size_t i = 0; i < input_count; ++i) {
+        if(stat(inputs[i], &sts[i]) < 0) {
+            trace_log(TRACE_LOG_ERROR, "Could not stat input `%s`: `%s`", inputs[i], strerror(errno));
+            goto defer;
+        }
+        if(common__mtime_ns(&sts[i]) > common__mtime_ns(&output_st)) stale = true;
+    }
+
+    Build_Cache* cache = common__build_cache;
+    if(cache == NULL) {
+        result = stale;
+        goto defer;
+    }
+
+    hashes = COMMON_MALLOC((input_count > 0 ? input_count : 1) * sizeof(*hashes));
+    if(!common__content_hashes(inputs, sts, input_count, hashes)) goto defer;
+    Hash64 h;
+    hash64_init(&h, input_count);
+    for(size_t i = 0; i < input_count; ++i) {
+        hash64_update(&h, sv_from_parts(inputs[i], strlen(inputs[i]) + 1));
+        hash64_update(&h, sv_from_parts((const char*)&hashes[i], sizeof(hashes[i])));
+    }
+    uint64_t inputs_hash = hash64_final(&h) | 1;
+
+    // The inputs are only recorded once the output is seen up to date; while the
+    // output stays untouched, inputs that changed since then keep it stale
+    Build_Cache_Entry* entry = build_cache__get(cache, output);
+    build_cache__stamp(cache, entry, &output_st);
+    if(entry->inputs_hash != 0) {
+        result = entry->inputs_hash != inputs_hash;
+    } else {
+        result = stale;
+        if(!stale) {
+            entry->inputs_hash = inputs_hash;
+            cache->changed = true;
+        }
+    }
+
+defer:
+    COMMON_FREE(sts);
+    COMMON_FREE(hashes);
+    return result;
+}
+
+static bool common__copy_fd(int dst, int src)
+{
+#if PLATFORM_LINUX && defined(SYS_copy_file_range)
+    // In kernel, falls back to read/write across filesystems that cannot do it
+    ssize_t n;
+    while((n = syscall(SYS_copy_file_range, src, NULL, dst, NULL, (size_t)1 << 30, 0)) > 0) {}
+    if(n == 0) return true;
+    if(errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) return false;
+#endif
+    char buffer[64*1024];
+    for(;;) {
+        ssize_t n = read(src, buffer, sizeof(buffer));
+        if(n < 0 && errno == EINTR) continue;
+        if(n < 0) return false;
+        if(n == 0) return true;
+        for(ssize_t written = 0; written < n;) {
+            ssize_t w = write(dst, buffer + written, (size_t)(n - written));
+            if(w < 0 && errno == EINTR) continue;
+            if(w < 0) return false;
+            written += w;
+        }
+    }
+}
+
+bool copy_file(const char* dst_path, const char* src_path)
+{
+    struct stat src_st, dst_st;
+    if(stat(src_path, &src_st) < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not stat file `%s`: `%s`", src_path, strerror(errno));
+        return false;
+    }
+
+    if(stat(dst_path, &dst_st) == 0 && dst_st.st_size == src_st.st_size) {
+        if(common__build_cache != NULL) {
+            const char* paths[2] = { src_path, dst_path };
+            struct stat sts[2] = { src_st, dst_st };
+            uint64_t hashes[2];
+            if(common__content_hashes(paths, sts, 2, hashes) && hashes[0] == hashes[1]) return true;
+        } else if(common__mtime_ns(&dst_st) == common__mtime_ns(&src_st)) {
+            return true;
+        }
+    }
+
+    int src = open(src_path, O_RDONLY);
+    if(src < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", src_path, strerror(errno));
+        return false;
+    }
+    int dst = open(dst_path, O_WRONLY | O_CREAT | O_TRUNC, src_st.st_mode & 0777);
+    if(dst < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", dst_path, strerror(errno));
+        close(src);
+        return false;
+    }
+
+    bool result = common__copy_fd(dst, src);
+    if(!result) trace_log(TRACE_LOG_ERROR, "Could not copy `%s` to `%s`: `%s`", src_path, dst_path, strerror(errno));
+    if(result) {
+        // The mtime of the source marks the copy as up to date without a cache
+        struct timespec times[2] = { { .tv_sec = 0, .tv_nsec = UTIME_OMIT } };
+#if PLATFORM_APPLE
+        times[1] = src_st.st_mtimespec;
+#else
+        times[1] = src_st.st_mtim;
+#endif
+        fchmod(dst, src_st.st_mode & 07777);
+        futimens(dst, times);
+        // The copy has the content of the source, no need to read it back
+        Build_Cache* cache = common__build_cache;
+        if(cache != NULL && fstat(dst, &dst_st) == 0) {
+            Build_Cache_Entry* src_entry = build_cache__get(cache, src_path);
+            build_cache__stamp(cache, src_entry, &src_st);
+            uint64_t hash = src_entry->hash;
+            Build_Cache_Entry* dst_entry = build_cache__get(cache, dst_path);
+            build_cache__stamp(cache, dst_entry, &dst_st);
+            dst_entry->hash = hash;
+        }
+    }
+    close(src);
+    if(close(dst) < 0) result = false;
+    return result;
+}
+
+bool copy_dir_recursive(const char* dst_path, const char* src_path)
+{
+    if(mkdir(dst_path, 0755) < 0 && errno != EEXIST) {
+        trace_log(TRACE_LOG_ERROR, "Could not create directory `%s`: `%s`", dst_path, strerror(errno));
+        return false;
+    }
+    Path_List children = {0};
+    bool result = read_dir(src_path, &children);
+    size_t src_length = strlen(src_path);
+    size_t dst_length = strlen(dst_path);
+    for(size_t i = 0; i < children.count; ++i) {
+        String_View name = children.data[i];
+        if(sv_eq(name, sv_from_cstr(".")) || sv_eq(name, sv_from_cstr(".."))) continue;
+
+        char* src_child = COMMON_MALLOC(src_length + name.count + 2);
+        char* dst_child = COMMON_MALLOC(dst_length + name.count + 2);
+        snprintf(src_child, src_length + name.count + 2, "%s/%.*s", src_path, (int)name.count, name.data);
+        snprintf(dst_child, dst_length + name.count + 2, "%s/%.*s", dst_path, (int)name.count, name.data);
+        struct stat st;
+        if(stat(src_child, &st) < 0) {
+            trace_log(TRACE_LOG_ERROR, "Could not stat file `%s`: `%s`", src_child, strerror(errno));
+            result = false;
+        } else if(S_ISDIR(st.st_mode)) {
+            result = copy_dir_recursive(dst_child, src_child) && result;
+        } else if(S_ISREG(st.st_mode)) {
+            result = copy_file(dst_child, src_child) && result;
+        }
+        COMMON_FREE(src_child);
+        COMMON_FREE(dst_child);
+    }
+
+    for(size_t i = 0; i < children.count; ++i) COMMON_FREE((char*)children.data[i].data);
+    da_free(&children);
+    return result;
+}
+
+#if PLATFORM_LINUX
+
+#define WATCHER_EVENTS (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF)
+#define WATCHER_MAX_WINDOWS 8
+
+static char* watcher__join(const char* dir, const char* name, size_t name_length)
+{
+    size_t dir_length = strlen(dir);
+    char* path = COMMON_MALLOC(dir_length + name_length + 2);
+    memcpy(path, dir, dir_length);
+    path[dir_length] = '/';
+    memcpy(path + dir_length + 1, name, name_length);
+    path[dir_length + name_length + 1] = '\0';
+    return path;
+}
+
+// Takes ownership of `path`
+static void watcher__report(File_Watcher* w, char* path)
+{
+    if((w->changed.count + 1) * 2 > w->seen_count) {
+        COMMON_FREE(w->seen);
+        w->seen_count = w->seen_count == 0 ? 64 : w->seen_count * 2;
+        w->seen = COMMON_MALLOC(w->seen_count * sizeof(*w->seen));
+        memset(w->seen, 0, w->seen_count * sizeof(*w->seen));
+        for(size_t i = 0; i < w->changed.count; ++i) {
+            size_t slot = (size_t)sv_hash64(w->changed.data[i], 0) & (w->seen_count - 1);
+            while(w->seen[slot] != 0) slot = (slot + 1) & (w->seen_count - 1);
+            w->seen[slot] = (uint32_t)(i + 1);
+        }
+    }
+
+    String_View sv = sv_from_cstr(path);
+    size_t slot = (size_t)sv_hash64(sv, 0) & (w->seen_count - 1);
+    while(w->seen[slot] != 0) {
+        if(sv_eq(w->changed.data[w->seen[slot] - 1], sv)) {
+            COMMON_FREE(path);
+            return;
+        }
+        slot = (slot + 1) & (w->seen_count - 1);
+    }
+    da_append(&w->changed, sv);
+    w->seen[slot] = (uint32_t)w->changed.count;
+}
+
+// Watches `path` and every directory below it, `report` also reports what is
+// already inside (a directory that just appeared may have been filled before
+// its watch was added)
+static bool watcher__add_dir(File_Watcher* w, const char* path, bool report)
+{
+    int wd = inotify_add_watch(w->fd, path, WATCHER_EVENTS | IN_ONLYDIR | IN_EXCL_UNLINK);
+    if(wd < 0) {
+        // Gone again before we got to it, the delete is reported on its own
+        if(errno == ENOENT || errno == ENOTDIR) return true;
+        trace_log(TRACE_LOG_ERROR, "Could not watch directory `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+    while(w->dir_paths.count <= (size_t)wd) da_append(&w->dir_paths, NULL);
+    COMMON_FREE(w->dir_paths.data[wd]);
+    size_t path_length = strlen(path);
+    w->dir_paths.data[wd] = COMMON_MALLOC(path_length + 1);
+    memcpy(w->dir_paths.data[wd], path, path_length + 1);
+
+    Path_List children = {0};
+    bool result = read_dir(path, &children);
+    for(size_t i = 0; i < children.count; ++i) {
+        String_View name = children.data[i];
+        if(sv_eq(name, sv_from_cstr(".")) || sv_eq(name, sv_from_cstr(".."))) continue;
+        char* child = watcher__join(path, name.data, name.count);
+        struct stat st;
+        if(lstat(child, &st) == 0 && S_ISDIR(st.st_mode)) result = watcher__add_dir(w, child, report) && result;
+        if(report) watcher__report(w, child);
+        else COMMON_FREE(child);
+    }
+    for(size_t i = 0; i < children.count; ++i) COMMON_FREE((char*)children.data[i].data);
+    da_free(&children);
+    return result;
+}
+
+// A directory moved away keeps its watches under the old path, drop them
+static void watcher__forget_tree(File_Watcher* w, const char* path)
+{
+    size_t length = strlen(path);
+    for(size_t wd = 0; wd < w->dir_paths.count; ++wd) {
+        char* dir = w->dir_paths.data[wd];
+        if(dir == NULL || strncmp(dir, path, length) != 0 || (dir[length] != '\0' && dir[length] != '/')) continue;
+        inotify_rm_watch(w->fd, (int)wd);
+        COMMON_FREE(dir);
+        w->dir_paths.data[wd] = NULL;
+    }
+}
+
+static void watcher__handle(File_Watcher* w, const struct inotify_event* e)
+{
+    if(e->mask & IN_Q_OVERFLOW) {
+        trace_log(TRACE_LOG_WARN, "inotify queue overflowed, reporting the watched roots");
+        for(size_t i = 0; i < w->roots.count; ++i) {
+            size_t length = strlen(w->roots.data[i]);
+            char* root = COMMON_MALLOC(length + 1);
+            memcpy(root, w->roots.data[i], length + 1);
+            watcher__report(w, root);
+        }
+        return;
+    }
+    if(e->wd < 0 || (size_t)e->wd >= w->dir_paths.count || w->dir_paths.data[e->wd] == NULL) return;
+    const char* dir = w->dir_paths.data[e->wd];
+    if(e->mask & IN_IGNORED) {
+        COMMON_FREE(w->dir_paths.data[e->wd]);
+        w->dir_paths.data[e->wd] = NULL;
+        return;
+    }
+
+    size_t name_length = e->len > 0 ? strlen(e->name) : 0;
+    char* path;
+    if(name_length == 0) {
+        size_t length = strlen(dir);
+        path = COMMON_MALLOC(length + 1);
+        memcpy(path, dir, length + 1);
+    } else {
+        path = watcher__join(dir, e->name, name_length);
+    }
+    if(e->mask & IN_ISDIR) {
+        if(e->mask & IN_MOVED_FROM) watcher__forget_tree(w, path);
+        if(e->mask & (IN_CREATE | IN_MOVED_TO)) watcher__add_dir(w, path, true);
+    }
+    watcher__report(w, path);
+}
+
+bool watcher_init(File_Watcher* w, int debounce_ms)
+{
+    memset(w, 0, sizeof(*w));
+    w->debounce_ms = debounce_ms;
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(w->fd < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not initialize inotify: `%s`", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool watcher_add_tree(File_Watcher* w, const char* root)
+{
+    size_t length = strlen(root);
+    while(length > 1 && root[length - 1] == '/') length -= 1;
+    char* path = COMMON_MALLOC(length + 1);
+    memcpy(path, root, length);
+    path[length] = '\0';
+    da_append(&w->roots, path);
+    return watcher__add_dir(w, path, false);
+}
+
+bool watcher_wait(File_Watcher* w, int timeout_ms)
+{
+    for(size_t i = 0; i < w->changed.count; ++i) COMMON_FREE((char*)w->changed.data[i].data);
+    w->changed.count = 0;
+    if(w->seen != NULL) memset(w->seen, 0, w->seen_count * sizeof(*w->seen));
+
+    char buffer[16*1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    double start = common__now_seconds();
+    double first_change = 0;
+    for(;;) {
+        // Until the first change the timeout counts, after it the quiet window
+        double now = common__now_seconds();
+        int wait_ms;
+        if(w->changed.count == 0) {
+            wait_ms = timeout_ms < 0 ? -1 : (int)(timeout_ms - (now - start) * 1000.0);
+            if(timeout_ms >= 0 && wait_ms <= 0) return false;
+        } else {
+            if(first_change == 0) first_change = now;
+            double cut_ms = (double)WATCHER_MAX_WINDOWS * w->debounce_ms - (now - first_change) * 1000.0;
+            wait_ms = cut_ms < w->debounce_ms ? (int)cut_ms : w->debounce_ms;
+            if(wait_ms <= 0) return true;
+        }
+
+        struct pollfd pfd = { .fd = w->fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, wait_ms);
+        if(ready < 0) {
+            if(errno == EINTR) continue;
+            trace_log(TRACE_LOG_ERROR, "Could not poll inotify: `%s`", strerror(errno));
+            return false;
+        }
+        if(ready == 0) {
+            if(w->changed.count > 0) return true;
+            continue;
+        }
+
+        for(;;) {
+            ssize_t n = read(w->fd, buffer, sizeof(buffer));
+            if(n < 0 && errno == EINTR) continue;
+            if(n < 0 && errno == EAGAIN) break;
+            if(n <= 0) {
+                trace_log(TRACE_LOG_ERROR, "Could not read inotify events: `%s`", strerror(errno));
+                return false;
+            }
+            for(ssize_t offset = 0; offset < n;) {
+                const struct inotify_event* e = (const struct inotify_event*)(buffer + offset);
+                watcher__handle(w, e);
+                offset += sizeof(*e) + e->len;
+            }
+        }
+    }
+}
+
+void watcher_free(File_Watcher* w)
+{
+    if(w->fd >= 0) close(w->fd);
+    for(size_t i = 0; i < w->dir_paths.count; ++i) COMMON_FREE(w->dir_paths.data[i]);
+    for(size_t i = 0; i < w->roots.count; ++i) COMMON_FREE(w->roots.data[i]);
+    for(size_t i = 0; i < w->changed.count; ++i) COMMON_FREE((char*)w->changed.data[i].data);
+    da_free(&w->dir_paths);
+    da_free(&w->roots);
+    da_free(&w->changed);
+    COMMON_FREE(w->seen);
+    memset(w, 0, sizeof(*w));
+    w->fd = -1;
+}
+
+#endif // PLATFORM_LINUX
+
+#define STREAM_READER_BACKEND_SYNC 0
+#define STREAM_READER_BACKEND_IO_URING 1
+#define STREAM_READER_BACKEND_THREAD 2
+
+struct Stream_Reader_Backend {
+    int kind;
+
+    // The single in flight request
+    int fd;
+    char* dst;
+    size_t size;
+    off_t offset;
+    ssize_t result;
+
+#if PLATFORM_LINUX
+    struct {
+        int fd;
+        void* sq_ptr;
+        size_t sq_size;
+        void* cq_ptr;
+        size_t cq_size;
+        struct io_uring_sqe* sqes;
+        size_t sqes_size;
+        unsigned* sq_head;
+        unsigned* sq_tail;
+        unsigned* sq_mask;
+        unsigned* sq_array;
+        unsigned* cq_head;
+        unsigned* cq_tail;
+        unsigned* cq_mask;
+        struct io_uring_cqe* cqes;
+    } uring;
+#endif
+
+    struct {
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        bool has_request;
+        bool has_result;
+        bool quit;
+    } worker;
+};
+
+#if PLATFORM_LINUX && !defined(STREAM_READER_NO_IO_URING)
+static bool sr__uring_init(Stream_Reader_Backend* b)
+{
+    struct io_uring_params p = {0};
+    int fd = (int)syscall(__NR_io_uring_setup, 2, &p);
+    if(fd < 0) return false;
+
+    b->uring.fd = fd;
+    b->uring.sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    b->uring.cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    b->uring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    b->uring.sq_ptr = mmap(NULL, b->uring.sq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    b->uring.cq_ptr = mmap(NULL, b->uring.cq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    b->uring.sqes = mmap(NULL, b->uring.sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if(b->uring.sq_ptr == MAP_FAILED || b->uring.cq_ptr == MAP_FAILED || b->uring.sqes == MAP_FAILED) {
+        if(b->uring.sq_ptr != MAP_FAILED) munmap(b->uring.sq_ptr, b->uring.sq_size);
+        if(b->uring.cq_ptr != MAP_FAILED) munmap(b->uring.cq_ptr, b->uring.cq_size);
+        if(b->uring.sqes != MAP_FAILED) munmap(b->uring.sqes, b->uring.sqes_size);
+        close(fd);
+        return false;
+    }
+
+    char* sq = b->uring.sq_ptr;
+    char* cq = b->uring.cq_ptr;
+    b->uring.sq_head = (unsigned*)(sq + p.sq_off.head);
+    b->uring.sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    b->uring.sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    b->uring.sq_array = (unsigned*)(sq + p.sq_off.array);
+    b->uring.cq_head = (unsigned*)(cq + p.cq_off.head);
+    b->uring.cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    b->uring.cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    b->uring.cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    b->kind = STREAM_READER_BACKEND_IO_URING;
+    return true;
+}
+
+static void sr__uring_deinit(Stream_Reader_Backend* b)
+{
+    munmap(b->uring.sq_ptr, b->uring.sq_size);
+    munmap(b->uring.cq_ptr, b->uring.cq_size);
+    munmap(b->uring.sqes, b->uring.sqes_size);
+    close(b->uring.fd);
+}
+
+#define SR_URING_SUBMIT_ATTEMPTS 16
+
+static bool sr__uring_submit(Stream_Reader_Backend* b)
+{
+    unsigned tail = *b->uring.sq_tail;
+    unsigned index = tail & *b->uring.sq_mask;
+    struct io_uring_sqe* sqe = &b->uring.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = b->fd;
+    sqe->addr = (unsigned long long)(size_t)b->dst;
+    sqe->len = (unsigned)b->size;
+    sqe->off = (unsigned long long)b->offset;
+    b->uring.sq_array[index] = index;
+    __atomic_store_n(b->uring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    // Interrupted or temporarily out of resources: the entry is still queued, try again
+    for(int attempt = 0; attempt < SR_URING_SUBMIT_ATTEMPTS;) {
+        long submitted = syscall(__NR_io_uring_enter, b->uring.fd, 1, 0, 0, NULL, 0);
+        if(submitted == 1) return true;
+        if(submitted < 0 && errno == EINTR) continue;
+        if(submitted != 0 && errno != EAGAIN && errno != EBUSY) break;
+        attempt += 1;
+        sched_yield();
+    }
+
+    // Take the entry back unless the kernel consumed it after all, otherwise the
+    // next enter would submit a stale read into a slot that is reused by then
+    if(__atomic_load_n(b->uring.sq_head, __ATOMIC_ACQUIRE) != tail) return true;
+    __atomic_store_n(b->uring.sq_tail, tail, __ATOMIC_RELEASE);
+    return false;
+}
+
+static void sr__uring_wait(Stream_Reader_Backend* b)
+{
+    for(;;) {
+        unsigned head = *b->uring.cq_head;
+        if(head != __atomic_load_n(b->uring.cq_tail, __ATOMIC_ACQUIRE)) {
+            b->result = b->uring.cqes[head & *b->uring.cq_mask].res;
+            __atomic_store_n(b->uring.cq_head, head + 1, __ATOMIC_RELEASE);
+            return;
+        }
+        if(syscall(__NR_io_uring_enter, b->uring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+                && errno != EINTR) {
+            b->result = -errno;
+            return;
+        }
+    }
+}
+#endif // PLATFORM_LINUX && !STREAM_READER_NO_IO_URING
+
+static void* sr__worker(void* arg)
+{
+    Stream_Reader_Backend* b = arg;
+    pthread_mutex_lock(&b->worker.mutex);
+    for(;;) {
+        while(!b->worker.has_request && !b->worker.quit)
+            pthread_cond_wait(&b->worker.cond, &b->worker.mutex);
+        if(b->worker.quit) break;
+        b->worker.has_request = false;
+        pthread_mutex_unlock(&b->worker.mutex);
+
+        ssize_t n = pread(b->fd, b->dst, b->size, b->offset);
+        b->result = n < 0 ? -errno : n;
+
+        pthread_mutex_lock(&b->worker.mutex);
+        b->worker.has_result = true;
+        pthread_cond_broadcast(&b->worker.cond);
+    }
+    pthread_mutex_unlock(&b->worker.mutex);
+    return NULL;
+}
+
+static bool sr__worker_init(Stream_Reader_Backend* b)
+{
+    if(pthread_mutex_init(&b->worker.mutex, NULL) != 0) return false;
+    if(pthread_cond_init(&b->worker.cond, NULL) != 0) {
+        pthread_mutex_destroy(&b->worker.mutex);
+        return false;
+    }
+    if(pthread_create(&b->worker.thread, NULL, sr__worker, b) != 0) {
+        pthread_cond_destroy(&b->worker.cond);
+        pthread_mutex_destroy(&b->worker.mutex);
+        return false;
+    }
+    b->kind = STREAM_READER_BACKEND_THREAD;
+    return true;
+}
+
+static void sr__worker_deinit(Stream_Reader_Backend* b)
+{
+    pthread_mutex_lock(&b->worker.mutex);
+    b->worker.quit = true;
+    pthread_cond_broadcast(&b->worker.cond);
+    pthread_mutex_unlock(&b->worker.mutex);
+    pthread_join(b->worker.thread, NULL);
+    pthread_cond_destroy(&b->worker.cond);
+    pthread_mutex_destroy(&b->worker.mutex);
+}
+
+// Start reading the next chunk of the file into `slot`
+static void sr__submit(Stream_Reader* sr, size_t slot)
+{
+    Stream_Reader_Backend* b = sr->backend;
+    b->fd = sr->fd;
+    b->dst = sr->slots[slot].data + sr->slots[slot].prefix;
+    b->size = sr->chunk_size;
+    b->offset = (off_t)sr->file_offset;
+    b->result = 0;
+    sr->pending = true;
+
+    switch(b->kind) {
+#if PLATFORM_LINUX && !defined(STREAM_READER_NO_IO_URING)
+        case STREAM_READER_BACKEND_IO_URING:
+            if(sr__uring_submit(b)) return;
+            // The ring refused the request, finish it synchronously in `sr__wait()`
+            b->result = -EAGAIN;
+            return;
+#endif
+        case STREAM_READER_BACKEND_THREAD:
+            pthread_mutex_lock(&b->worker.mutex);
+            b->worker.has_request = true;
+            b->worker.has_result = false;
+            pthread_cond_broadcast(&b->worker.cond);
+            pthread_mutex_unlock(&b->worker.mutex);
+            return;
+        default:
+            return;
+    }
+}
+
+// Wait for the in flight chunk, returns the amount of bytes read or -1 on error
+static ssize_t sr__wait(Stream_Reader* sr)
+{
+    Stream_Reader_Backend* b = sr->backend;
+    sr->pending = false;
+
+    bool done = false;
+    switch(b->kind) {
+#if PLATFORM_LINUX && !defined(STREAM_READER_NO_IO_URING)
+        case STREAM_READER_BACKEND_IO_URING:
+            if(b->result != -EAGAIN) {
+                sr__uring_wait(b);
+                done = true;
+            }
+            break;
+#endif
+        case STREAM_READER_BACKEND_THREAD:
+            pthread_mutex_lock(&b->worker.mutex);
+            while(!b->worker.has_result)
+                pthread_cond_wait(&b->worker.cond, &b->worker.mutex);
+            pthread_mutex_unlock(&b->worker.mutex);
+            done = true;
+            break;
+        default:
+            break;
+    }
+
+    // Kernels without IORING_OP_READ answer with -EINVAL, plain pread still works there
+    size_t count = 0;
+    if(done && b->result >= 0) count = (size_t)b->result;
+    if(!done || b->result == -EINVAL) {
+        ssize_t n = pread(b->fd, b->dst, b->size, b->offset);
+        if(n < 0) b->result = -errno;
+        else { b->result = n; count = (size_t)n; }
+    }
+    if(b->result < 0) {
+        errno = (int)-b->result;
+        return -1;
+    }
+
+    // Short reads are only final once pread says so
+    while(count > 0 && count < b->size) {
+        ssize_t n = pread(b->fd, b->dst + count, b->size - count, b->offset + count);
+        if(n < 0) return -1;
+        if(n == 0) break;
+        count += (size_t)n;
+    }
+    sr->file_offset += count;
+    return (ssize_t)count;
+}
+
+// Swap to the other slot, carrying the unparsed tail of the current one in front of it
+static bool sr__advance(Stream_Reader* sr)
+{
+    size_t next = 1 - sr->current;
+    ssize_t n = sr__wait(sr);
+    if(n < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not read from stream: `%s`", strerror(errno));
+        return false;
+    }
+
+    Stream_Reader_Slot* slot = &sr->slots[next];
+    String_View tail = sr->window;
+    if(tail.count > slot->prefix) {
+        // A record longer than the reserved prefix, make room for it once
+        size_t prefix = slot->prefix * 2;
+        if(prefix < tail.count) prefix = tail.count;
+        char* data = COMMON_MALLOC(prefix + sr->chunk_size);
+        if(data == NULL) return false;
+        memcpy(data + prefix, slot->data + slot->prefix, (size_t)n);
+        COMMON_FREE(slot->data);
+        slot->data = data;
+        slot->prefix = prefix;
+    }
+
+    char* start = slot->data + slot->prefix - tail.count;
+    memmove(start, tail.data, tail.count);
+    sr->window = sv_from_parts(start, tail.count + (size_t)n);
+    sr->current = next;
+
+    if(n == 0) sr->eof = true;
+    else sr__submit(sr, 1 - next);
+    return true;
+}
+
+bool sr_open(Stream_Reader* sr, const char* path, size_t chunk_size)
+{
+    if(chunk_size == 0) chunk_size = STREAM_READER_DEFAULT_CHUNK_SIZE;
+    COMMON_ASSERT(chunk_size <= 0x7fffffff && "io_uring reads are limited to 32-bit lengths");
+
+    memset(sr, 0, sizeof(*sr));
+    sr->fd = open(path, O_RDONLY);
+    if(sr->fd < 0) {
+        trace_log(TRACE_LOG_ERROR, "Could not open file `%s`: `%s`", path, strerror(errno));
+        return false;
+    }
+    sr->opened = true;
+
+    sr->chunk_size = chunk_size;
+    sr->backend = COMMON_MALLOC(sizeof(Stream_Reader_Backend));
+    if(sr->backend) memset(sr->backend, 0, sizeof(*sr->backend));
+    for(size_t i = 0; i < 2; ++i) {
+        sr->slots[i].prefix = chunk_size;
+        sr->slots[i].data = COMMON_MALLOC(sr->slots[i].prefix + chunk_size);
+    }
+    if(sr->backend == NULL || sr->slots[0].data == NULL || sr->slots[1].data == NULL) {
+        trace_log(TRACE_LOG_ERROR, "Could not allocate stream buffers for `%s`", path);
+        sr_close(sr);
+        return false;
+    }
+
+    bool async = false;
+#if PLATFORM_LINUX && !defined(STREAM_READER_NO_IO_URING)
+    async = sr__uring_init(sr->backend);
+#endif
+    if(!async) async = sr__worker_init(sr->backend);
+    if(!async) sr->backend->kind = STREAM_READER_BACKEND_SYNC;
+
+    // Pretend slot 1 was just drained so the first advance lands on slot 0
+    sr->current = 1;
+    sr->window = sv_from_parts(sr->slots[1].data + sr->slots[1].prefix, 0);
+    sr__submit(sr, 0);
+    return true;
+}
+
+void sr_close(Stream_Reader* sr)
+{
+    Stream_Reader_Backend* b = sr->backend;
+    if(b) {
+        if(sr->pending) sr__wait(sr);
+        switch(b->kind) {
+#if PLATFORM_LINUX && !defined(STREAM_READER_NO_IO_URING)
+            case STREAM_READER_BACKEND_IO_URING: sr__uring_deinit(b); break;
+#endif
+            case STREAM_READER_BACKEND_THREAD: sr__worker_deinit(b); break;
+            default: break;
+        }
+        COMMON_FREE(b);
+    }
+    for(size_t i = 0; i < 2; ++i) COMMON_FREE(sr->slots[i].data);
+    if(sr->opened) close(sr->fd);
+    memset(sr, 0, sizeof(*sr));
+    sr->fd = -1;
+}
+
+bool sr_next_record(Stream_Reader* sr, char delim, String_View* record)
+{
+    size_t scanned = 0;
+    for(;;) {
+        const char* found = memchr(sr->window.data + scanned, delim, sr->window.count - scanned);
+        if(found != NULL) {
+            *record = sv_chop_left(&sr->window, (size_t)(found - sr->window.data));
+            sv_chop_left(&sr->window, 1);
+            return true;
+        }
+
+        if(sr->eof) {
+            if(sr->window.count == 0) return false;
+            *record = sv_chop_by_delim(&sr->window, delim);
+            return true;
+        }
+
+        // The tail is carried over as is, no need to scan it again
+        scanned = sr->window.count;
+        if(!sr__advance(sr)) return false;
+    }
+}
+
+bool sr_next_line(Stream_Reader* sr, String_View* line)
+{
+    return sr_next_record(sr, '\n', line);
+}
+
+#endif // !PLATFORM_WINDOWS
+
 #endif // COMMON_PLATFORM_INDEPENDENT
 
 #if PLATFORM_WINDOWS
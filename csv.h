@@ -0,0 +1,393 @@
+#ifndef CSV_H
+#define CSV_H
+
+/**
+ * Zero-copy CSV/TSV reader on top of `common.h` and `arena.h`
+ *
+ * Input is indexed in windows of 64 byte blocks: one bitmask each for quotes,
+ * delimiters and newlines, a prefix xor of the quote mask to drop everything
+ * inside quotes, and the remaining bits become field boundaries. With
+ * `COMMON_SIMD` the masks come from AVX2 or SSE2 compares.
+ *
+ * Rows are `String_View`s into the input, quoted fields keep their quotes until
+ * `csv_unescape()` is called on them. The input is never written to, so it can
+ * be a read-only memory map. `\r\n` line endings are accepted, a quoted field
+ * may span lines.
+ *
+ * `csv_split()` cuts the input into chunks of whole rows that can be read on
+ * different threads: the quote parity of every chunk gives the quote state at
+ * its start, and the chunk begins after its first unquoted newline.
+ * `csv_parse_parallel()` does that on `CSV_THREADS` pthreads.
+ *
+ * `common.h` and `arena.h` must be implemented somewhere.
+ */
+
+#include "common.h"
+#include "arena.h"
+
+#ifndef CSV_MAX_THREADS
+    #define CSV_MAX_THREADS 64
+#endif
+
+// Bytes indexed per refill, a multiple of 64 below 4GB
+#ifndef CSV_WINDOW_SIZE
+    #define CSV_WINDOW_SIZE (64*1024)
+#endif
+
+typedef struct {
+    char delimiter;
+    char quote; // 0 disables quoting
+} Csv_Dialect;
+
+#define CSV_DIALECT_CSV ((Csv_Dialect){ .delimiter = ',', .quote = '"' })
+#define CSV_DIALECT_TSV ((Csv_Dialect){ .delimiter = '\t', .quote = 0 })
+
+typedef da(String_View) Csv_Row;
+
+typedef struct {
+    String_View input;
+    Csv_Dialect dialect;
+    size_t row_start;
+
+    // Field boundaries in [window_start, window_end), relative to window_start
+    uint32_t* index;
+    size_t index_count, index_cursor;
+    size_t window_start, window_end;
+    bool in_quote; // at window_end
+} Csv_Reader;
+
+void csv_reader_init(Csv_Reader* r, String_View input, Csv_Dialect dialect);
+void csv_reader_free(Csv_Reader* r);
+
+/**
+ * Replaces the contents of `row` with the fields of the next row, false at
+ * the end of the input. An empty line is a row with one empty field.
+ */
+bool csv_next_row(Csv_Reader* r, Csv_Row* row);
+
+/**
+ * The field without its quotes. Only a field with escaped quotes inside is
+ * copied into `a`, everything else points into the input.
+ */
+String_View csv_unescape(Arena* a, String_View field, Csv_Dialect dialect);
+
+/**
+ * Initializes up to `chunk_count` readers over consecutive runs of whole rows
+ * and returns how many, free each one with `csv_reader_free()`.
+ */
+size_t csv_split(String_View input, Csv_Dialect dialect, size_t chunk_count, Csv_Reader* readers);
+
+/**
+ * Calls `fn` for every row, rows of the same chunk in order on the same thread.
+ * `row` is only valid during the call.
+ */
+typedef void (*Csv_Row_Fn)(void* user, size_t chunk, const Csv_Row* row);
+void csv_parse_parallel(String_View input, Csv_Dialect dialect, Csv_Row_Fn fn, void* user);
+
+#endif // CSV_H
+
+#ifdef CSV_IMPLEMENTATION
+
+#include <string.h> // memcpy, memchr
+
+#if COMMON_SIMD_AVX2 || COMMON_SIMD_SSE2
+    #include <immintrin.h>
+#endif
+
+#ifdef CSV_THREADS
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+typedef struct {
+    uint64_t quotes, delimiters, newlines;
+} Csv__Masks;
+
+// Exactly 64 readable bytes at `p`
+static inline Csv__Masks csv__masks(const unsigned char* p, Csv_Dialect dialect)
+{
+    Csv__Masks m;
+#if COMMON_SIMD_AVX2
+    const __m256i quote = _mm256_set1_epi8(dialect.quote);
+    const __m256i delimiter = _mm256_set1_epi8(dialect.delimiter);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i lo = _mm256_loadu_si256((const __m256i*)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(p + 32));
+#define csv__mask64(c) \
+    ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, c)) \
+     | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, c)) << 32)
+    m.quotes = csv__mask64(quote);
+    m.delimiters = csv__mask64(delimiter);
+    m.newlines = csv__mask64(newline);
+#undef csv__mask64
+#elif COMMON_SIMD_SSE2
+    const __m128i quote = _mm_set1_epi8(dialect.quote);
+    const __m128i delimiter = _mm_set1_epi8(dialect.delimiter);
+    const __m128i newline = _mm_set1_epi8('\n');
+    m.quotes = m.delimiters = m.newlines = 0;
+    for(int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + 16*i));
+        m.quotes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << 16*i;
+        m.delimiters |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, delimiter)) << 16*i;
+        m.newlines |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << 16*i;
+    }
+#else
+    m.quotes = m.delimiters = m.newlines = 0;
+    for(int i = 0; i < 64; ++i) {
+        m.quotes |= (uint64_t)(p[i] == (unsigned char)dialect.quote) << i;
+        m.delimiters |= (uint64_t)(p[i] == (unsigned char)dialect.delimiter) << i;
+        m.newlines |= (uint64_t)(p[i] == '\n') << i;
+    }
+#endif
+    if(dialect.quote == 0) m.quotes = 0;
+    return m;
+}
+
+// Bit i set when an odd number of quotes is at or before i
+static inline uint64_t csv__prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+static inline int csv__ctz64(uint64_t x)
+{
+#if CC_MSVC
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Unquoted delimiters and newlines of one 64 byte block
+static inline uint64_t csv__structurals(const unsigned char* p, Csv_Dialect dialect, bool* in_quote)
+{
+    Csv__Masks m = csv__masks(p, dialect);
+    uint64_t inside = csv__prefix_xor(m.quotes) ^ (*in_quote ? ~(uint64_t)0 : 0);
+    *in_quote = inside >> 63;
+    return (m.delimiters | m.newlines) & ~inside;
+}
+
+// Indexes the next window, the last partial block goes through a padded copy
+static void csv__refill(Csv_Reader* r)
+{
+    const unsigned char* s = (const unsigned char*)r->input.data;
+    size_t start = r->window_end;
+    size_t end = start + CSV_WINDOW_SIZE < r->input.count ? start + CSV_WINDOW_SIZE : r->input.count;
+    size_t count = 0;
+    for(size_t block = start; block < end; block += 64) {
+        uint64_t bits;
+        if(block + 64 <= r->input.count) {
+            bits = csv__structurals(s + block, r->dialect, &r->in_quote);
+        } else {
+            unsigned char tail[64] = {0};
+            memcpy(tail, s + block, r->input.count - block);
+            bits = csv__structurals(tail, r->dialect, &r->in_quote);
+            bits &= ((uint64_t)1 << (r->input.count - block)) - 1;
+        }
+        while(bits != 0) {
+            r->index[count++] = (uint32_t)(block - start + (size_t)csv__ctz64(bits));
+            bits &= bits - 1;
+        }
+    }
+    r->window_start = start;
+    r->window_end = end;
+    r->index_count = count;
+    r->index_cursor = 0;
+}
+
+void csv_reader_init(Csv_Reader* r, String_View input, Csv_Dialect dialect)
+{
+    memset(r, 0, sizeof(*r));
+    r->input = input;
+    r->dialect = dialect;
+    r->index = COMMON_MALLOC(CSV_WINDOW_SIZE * sizeof(*r->index));
+}
+
+void csv_reader_free(Csv_Reader* r)
+{
+    COMMON_FREE(r->index);
+    r->index = NULL;
+}
+
+bool csv_next_row(Csv_Reader* r, Csv_Row* row)
+{
+    row->count = 0;
+    if(r->row_start >= r->input.count) return false;
+
+    size_t field_start = r->row_start;
+    for(;;) {
+        if(r->index_cursor == r->index_count) {
+            if(r->window_end == r->input.count) {
+                // Last row without a newline
+                da_append(row, sv_from_parts(r->input.data + field_start, r->input.count - field_start));
+                r->row_start = r->input.count;
+                return true;
+            }
+            csv__refill(r);
+            continue;
+        }
+        size_t at = r->window_start + r->index[r->index_cursor++];
+        String_View field = sv_from_parts(r->input.data + field_start, at - field_start);
+        field_start = at + 1;
+        if(r->input.data[at] == '\n') {
+            if(field.count > 0 && field.data[field.count - 1] == '\r') field.count -= 1;
+            da_append(row, field);
+            r->row_start = field_start;
+            return true;
+        }
+        da_append(row, field);
+    }
+}
+
+String_View csv_unescape(Arena* a, String_View field, Csv_Dialect dialect)
+{
+    if(dialect.quote == 0 || field.count == 0 || field.data[0] != dialect.quote) return field;
+
+    String_View inner = sv_from_parts(field.data + 1, field.count - 1);
+    if(inner.count > 0 && inner.data[inner.count - 1] == dialect.quote) inner.count -= 1;
+    if(memchr(inner.data, dialect.quote, inner.count) == NULL) return inner;
+
+    char* unescaped = arena_alloc(a, inner.count);
+    size_t n = 0;
+    for(size_t i = 0; i < inner.count; ++i) {
+        unescaped[n++] = inner.data[i];
+        if(inner.data[i] == dialect.quote && i + 1 < inner.count && inner.data[i + 1] == dialect.quote) ++i;
+    }
+    return sv_from_parts(unescaped, n);
+}
+
+typedef struct {
+    String_View input;
+    Csv_Dialect dialect;
+    bool odd_quotes;
+    Csv_Row_Fn fn;
+    void* user;
+    Csv_Reader* reader;
+    size_t chunk;
+} Csv__Job;
+
+typedef void (*Csv__Job_Fn)(Csv__Job* job);
+
+static void csv__count_quotes(Csv__Job* job)
+{
+    const unsigned char* s = (const unsigned char*)job->input.data;
+    size_t n = job->input.count;
+    uint64_t parity = 0;
+    size_t i = 0;
+    for(; i + 64 <= n; i += 64) parity ^= csv__masks(s + i, job->dialect).quotes;
+    for(; i < n; ++i) parity ^= job->dialect.quote != 0 && s[i] == (unsigned char)job->dialect.quote;
+    job->odd_quotes = csv__prefix_xor(parity) >> 63;
+}
+
+static void csv__read_chunk(Csv__Job* job)
+{
+    Csv_Row row = {0};
+    while(csv_next_row(job->reader, &row)) job->fn(job->user, job->chunk, &row);
+    da_free(&row);
+}
+
+#ifdef CSV_THREADS
+typedef struct {
+    Csv__Job_Fn fn;
+    Csv__Job* job;
+} Csv__Thread;
+
+static void* csv__thread_run(void* arg)
+{
+    Csv__Thread* thread = arg;
+    thread->fn(thread->job);
+    return NULL;
+}
+#endif
+
+// One job per thread, the calling thread takes the last one
+static void csv__run_jobs(Csv__Job_Fn fn, Csv__Job* jobs, size_t count)
+{
+#ifdef CSV_THREADS
+    Csv__Thread threads[CSV_MAX_THREADS];
+    pthread_t handles[CSV_MAX_THREADS];
+    bool spawned[CSV_MAX_THREADS];
+    for(size_t i = 0; i + 1 < count; ++i) {
+        threads[i] = (Csv__Thread){ .fn = fn, .job = &jobs[i] };
+        spawned[i] = pthread_create(&handles[i], NULL, csv__thread_run, &threads[i]) == 0;
+        if(!spawned[i]) fn(&jobs[i]);
+    }
+    if(count > 0) fn(&jobs[count - 1]);
+    for(size_t i = 0; i + 1 < count; ++i) {
+        if(spawned[i]) pthread_join(handles[i], NULL);
+    }
+#else
+    for(size_t i = 0; i < count; ++i) fn(&jobs[i]);
+#endif
+}
+
+// First byte after an unquoted newline at or after `from`, given the quote state at `from`
+static size_t csv__next_row_start(String_View input, Csv_Dialect dialect, size_t from, bool in_quote)
+{
+    for(size_t i = from; i < input.count; ++i) {
+        char c = input.data[i];
+        if(dialect.quote != 0 && c == dialect.quote) in_quote = !in_quote;
+        else if(c == '\n' && !in_quote) return i + 1;
+    }
+    return input.count;
+}
+
+size_t csv_split(String_View input, Csv_Dialect dialect, size_t chunk_count, Csv_Reader* readers)
+{
+    if(chunk_count > CSV_MAX_THREADS) chunk_count = CSV_MAX_THREADS;
+    if(chunk_count > input.count / CSV_WINDOW_SIZE) chunk_count = input.count / CSV_WINDOW_SIZE;
+    if(chunk_count == 0) chunk_count = 1;
+
+    Csv__Job jobs[CSV_MAX_THREADS];
+    for(size_t k = 0; k < chunk_count; ++k) {
+        size_t begin = input.count / chunk_count * k;
+        size_t end = k + 1 == chunk_count ? input.count : input.count / chunk_count * (k + 1);
+        jobs[k] = (Csv__Job){ .input = sv_from_parts(input.data + begin, end - begin), .dialect = dialect };
+    }
+    csv__run_jobs(csv__count_quotes, jobs, chunk_count);
+
+    size_t starts[CSV_MAX_THREADS + 1];
+    bool in_quote = false;
+    starts[0] = 0;
+    for(size_t k = 1; k < chunk_count; ++k) {
+        in_quote ^= jobs[k - 1].odd_quotes;
+        size_t begin = (size_t)(jobs[k].input.data - input.data);
+        starts[k] = csv__next_row_start(input, dialect, begin, in_quote);
+        if(starts[k] < starts[k - 1]) starts[k] = starts[k - 1];
+    }
+    starts[chunk_count] = input.count;
+
+    for(size_t k = 0; k < chunk_count; ++k) {
+        String_View chunk = sv_from_parts(input.data + starts[k], starts[k + 1] - starts[k]);
+        csv_reader_init(&readers[k], chunk, dialect);
+    }
+    return chunk_count;
+}
+
+void csv_parse_parallel(String_View input, Csv_Dialect dialect, Csv_Row_Fn fn, void* user)
+{
+    size_t threads = 1;
+#ifdef CSV_THREADS
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (size_t)online : 1;
+#endif
+    Csv_Reader readers[CSV_MAX_THREADS];
+    size_t count = csv_split(input, dialect, threads, readers);
+
+    Csv__Job jobs[CSV_MAX_THREADS];
+    for(size_t k = 0; k < count; ++k) {
+        jobs[k] = (Csv__Job){ .fn = fn, .user = user, .reader = &readers[k], .chunk = k };
+    }
+    csv__run_jobs(csv__read_chunk, jobs, count);
+    for(size_t k = 0; k < count; ++k) csv_reader_free(&readers[k]);
+}
+
+#endif // CSV_IMPLEMENTATION
@@ -0,0 +1,74 @@
+#define ARENA_IMPLEMENTATION
+#include "../arena.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static int alive = 0;
+
+struct Tracked {
+    int value;
+    explicit Tracked(int value) : value(value) { alive += 1; }
+    ~Tracked() { alive -= 1; }
+};
+
+struct alignas(64) Wide {
+    float lanes[16];
+};
+
+int main(void)
+{
+    Arena arena = {};
+    Arena_Resource resource(&arena);
+
+    // Request-scoped containers, all gone before the arena is reset
+    {
+        // Grows past a single region
+        std::pmr::vector<int> numbers(&resource);
+        for(int i = 0; i < 100000; ++i) numbers.push_back(i);
+        for(int i = 0; i < 100000; ++i) assert(numbers[i] == i);
+        assert(arena.first != nullptr && arena.first->next != nullptr);
+
+        std::pmr::unordered_map<std::pmr::string, int> counts(&resource);
+        for(int i = 0; i < 1000; ++i) counts[std::pmr::string("a long enough key to skip sso #") + std::to_string(i % 100).c_str()] += 1;
+        assert(counts.size() == 100);
+        for(const auto& [key, count] : counts) assert(count == 10);
+
+        std::vector<Wide, Arena_Allocator<Wide>> wides{Arena_Allocator<Wide>(&arena)};
+        for(int i = 0; i < 100; ++i) {
+            wides.push_back(Wide{});
+            assert(reinterpret_cast<std::uintptr_t>(wides.data()) % 64 == 0);
+        }
+        assert(Arena_Allocator<int>(&arena) == Arena_Allocator<Wide>(&arena));
+    }
+
+    {
+        arena_unique_ptr<Tracked> owned = arena_make_unique<Tracked>(&arena, 7);
+        assert(owned->value == 7 && alive == 1);
+    }
+    assert(alive == 0);
+
+    for(int i = 0; i < 10; ++i) {
+        Tracked* t = arena_new<Tracked>(&arena, i);
+        assert(t->value == i);
+    }
+    assert(alive == 10);
+    Wide* wide = arena_new<Wide>(&arena);
+    assert(reinterpret_cast<std::uintptr_t>(wide) % 64 == 0);
+
+    arena_reset(&arena);
+    assert(alive == 0);
+    assert(arena.finalizers == nullptr);
+
+    arena_new<Tracked>(&arena, 1);
+    assert(alive == 1);
+    arena_free(&arena);
+    assert(alive == 0);
+
+    printf("OK\n");
+    return 0;
+}
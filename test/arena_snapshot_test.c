@@ -0,0 +1,135 @@
+#define ARENA_IMPLEMENTATION
+#include "../arena.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SNAPSHOT_PATH "/tmp/arena_snapshot_test.img"
+#define BUCKET_COUNT 1024
+#define ENTRY_COUNT 20000
+
+// A chained hash table built only from Rel_Ptrs
+typedef struct {
+    Rel_Ptr next;
+    Rel_Ptr key;
+    int value;
+} Entry;
+
+typedef struct {
+    size_t count;
+    Rel_Ptr buckets[BUCKET_COUNT];
+} Table;
+
+static size_t hash(const char* key)
+{
+    size_t h = 5381;
+    while(*key) h = h * 33 + (unsigned char)*key++;
+    return h % BUCKET_COUNT;
+}
+
+static void table_put(Arena* a, Table* t, const char* key, int value)
+{
+    Entry* e = arena_alloc_aligned(a, sizeof(Entry), sizeof(void*));
+    char* copy = arena_alloc(a, strlen(key) + 1);
+    strcpy(copy, key);
+    rel_ptr_set(&e->key, copy);
+    e->value = value;
+    Rel_Ptr* bucket = &t->buckets[hash(key)];
+    rel_ptr_set(&e->next, rel_ptr_get(bucket));
+    rel_ptr_set(bucket, e);
+    t->count += 1;
+}
+
+static Entry* table_get(Table* t, const char* key)
+{
+    for(Entry* e = rel_ptr_get(&t->buckets[hash(key)]); e != NULL; e = rel_ptr_get(&e->next)) {
+        if(strcmp(rel_ptr_get(&e->key), key) == 0) return e;
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    char key[32];
+    {
+        Arena arena = {0};
+        arena_reserve(&arena, 4*1024*1024);
+        Table* table = arena_alloc_aligned(&arena, sizeof(Table), 16);
+        memset(table, 0, sizeof(*table));
+        for(int i = 0; i < ENTRY_COUNT; ++i) {
+            snprintf(key, sizeof(key), "key-%d", i);
+            table_put(&arena, table, key, i * 3);
+        }
+        assert(arena.first == arena.last);
+        assert(arena_snapshot(&arena, SNAPSHOT_PATH));
+        arena_free(&arena);
+    }
+    printf("snapshot ok\n");
+
+    {
+        Arena arena = {0};
+        Table* table = arena_restore(&arena, SNAPSHOT_PATH);
+        assert(table != NULL);
+        assert(table->count == ENTRY_COUNT);
+        for(int i = 0; i < ENTRY_COUNT; ++i) {
+            snprintf(key, sizeof(key), "key-%d", i);
+            Entry* e = table_get(table, key);
+            assert(e != NULL && e->value == i * 3);
+        }
+        assert(table_get(table, "missing") == NULL);
+
+        // Writes are private, and the arena keeps growing past the image
+        table_get(table, "key-7")->value = -1;
+        table_put(&arena, table, "new", 1);
+        assert(table_get(table, "new")->value == 1);
+        arena_free(&arena);
+
+        table = arena_restore(&arena, SNAPSHOT_PATH);
+        assert(table_get(table, "key-7")->value == 21);
+        assert(table_get(table, "new") == NULL);
+        arena_free(&arena);
+    }
+    printf("restore ok\n");
+
+    // Several regions come back in order with their contents and alignment
+    {
+        Arena arena = {0};
+        uint64_t* blocks[8];
+        for(int i = 0; i < 8; ++i) {
+            blocks[i] = arena_alloc_aligned(&arena, REGION_DEFAULT_CAPACITY / 2 + 8, 64);
+            for(size_t j = 0; j < (REGION_DEFAULT_CAPACITY / 2 + 8) / 8; ++j) blocks[i][j] = (uint64_t)i * 1000003u + j;
+        }
+        assert(arena_snapshot(&arena, SNAPSHOT_PATH));
+
+        Arena restored = {0};
+        assert(arena_restore(&restored, SNAPSHOT_PATH) != NULL);
+        Region* r = arena.first;
+        Region* s = restored.first;
+        for(; r != NULL && r->usage > 0; r = r->next, s = s->next) {
+            assert(s != NULL && s->usage == r->usage);
+            assert((uintptr_t)s->data % 64 == (uintptr_t)r->data % 64);
+            assert(memcmp(s->data, r->data, r->usage) == 0);
+        }
+        assert(s == NULL);
+        arena_free(&restored);
+        arena_free(&arena);
+    }
+    printf("regions ok\n");
+
+    // Anything that is not an image is refused
+    {
+        FILE* f = fopen(SNAPSHOT_PATH, "wb");
+        fputs("definitely not an arena image", f);
+        fclose(f);
+        Arena arena = {0};
+        assert(arena_restore(&arena, SNAPSHOT_PATH) == NULL);
+        assert(arena.first == NULL && arena.image == NULL);
+        assert(arena_restore(&arena, "/nonexistent/arena.img") == NULL);
+    }
+    printf("invalid ok\n");
+
+    remove(SNAPSHOT_PATH);
+    return 0;
+}
@@ -2,7 +2,9 @@
 set -xe
 
 CC="clang"
-CFLAGS="-Wall -Wextra -Wpedantic -I.."
+CFLAGS="-Wall -Wextra -Wpedantic -I.. -pthread"
+CXX="clang++"
+CXXFLAGS="-std=c++17 -Wall -Wextra -Wpedantic -I.."
 
 BUILD_DIR="build"
 
@@ -11,5 +13,30 @@ if [ ! -d $BUILD_DIR ]; then
 fi
 
 $CC $CFLAGS -o $BUILD_DIR/string_view_test string_view_test.c
+$CC $CFLAGS -mavx2 -o $BUILD_DIR/utf8_test utf8_test.c
+$CC $CFLAGS -DUTF8_TEST_NO_SIMD -o $BUILD_DIR/utf8_scalar_test utf8_test.c
+$CC $CFLAGS -o $BUILD_DIR/string_view_hash_test string_view_hash_test.c
+$CC $CFLAGS -o $BUILD_DIR/string_view_ci_test string_view_ci_test.c
+$CC $CFLAGS -mavx2 -o $BUILD_DIR/csv_test csv_test.c
+$CC $CFLAGS -mno-avx2 -o $BUILD_DIR/csv_sse2_test csv_test.c
+$CC $CFLAGS -DCSV_TEST_NO_SIMD -o $BUILD_DIR/csv_scalar_test csv_test.c
 $CC $CFLAGS -o $BUILD_DIR/arena_libc_backend_test arena_libc_backend_test.c
+$CC $CFLAGS -o $BUILD_DIR/arena_snapshot_test arena_snapshot_test.c
 $CC $CFLAGS -o $BUILD_DIR/common_test common_test.c
+$CC $CFLAGS -o $BUILD_DIR/queue_test queue_test.c
+$CC $CFLAGS -o $BUILD_DIR/cmd_test cmd_test.c
+$CC $CFLAGS -o $BUILD_DIR/build_cache_test build_cache_test.c
+$CC $CFLAGS -o $BUILD_DIR/chunked_builder_test chunked_builder_test.c
+$CC $CFLAGS -o $BUILD_DIR/file_watcher_test file_watcher_test.c
+$CC $CFLAGS -o $BUILD_DIR/common_track_allocs_test common_track_allocs_test.c
+$CC $CFLAGS -o $BUILD_DIR/stream_reader_test stream_reader_test.c
+$CC $CFLAGS -DSTREAM_READER_NO_IO_URING -o $BUILD_DIR/stream_reader_thread_test stream_reader_test.c
+$CC $CFLAGS -msse4.1 -mavx2 -mfma -o $BUILD_DIR/cgm_simd_test cgm_simd_test.c -lm
+$CC $CFLAGS -msse4.1 -mavx2 -mfma -o $BUILD_DIR/cgm_fast_math_test cgm_fast_math_test.c -lm
+$CC $CFLAGS -msse4.1 -mavx2 -mfma -o $BUILD_DIR/cgm_quat_test cgm_quat_test.c -lm
+$CC $CFLAGS -msse4.1 -mavx2 -mfma -o $BUILD_DIR/cgm_transform_test cgm_transform_test.c -lm
+$CC $CFLAGS -msse4.1 -mavx2 -mfma -o $BUILD_DIR/cgm_cull_test cgm_cull_test.c -lm
+$CC $CFLAGS -o $BUILD_DIR/transform_test transform_test.c -lm
+$CC $CFLAGS -x c -DCGM_IMPLEMENTATION -c -o $BUILD_DIR/cgm.o ../cgm.h
+$CXX $CXXFLAGS -o $BUILD_DIR/cgm_hpp_test cgm_hpp_test.cpp $BUILD_DIR/cgm.o -lm
+$CXX $CXXFLAGS -o $BUILD_DIR/arena_hpp_test arena_hpp_test.cpp
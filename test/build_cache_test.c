@@ -0,0 +1,174 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROOT "/tmp/build_cache_test"
+#define INDEX ROOT "/cache.idx"
+#define BIG_SIZE (FILE_HASH_CHUNK_SIZE * 2 + 12345)
+
+static void write_file(const char* path, const char* content)
+{
+    assert(save_file_data(path, content, strlen(content)));
+}
+
+static void set_mtime(const char* path, time_t seconds)
+{
+    struct timespec times[2] = { { .tv_sec = seconds }, { .tv_sec = seconds } };
+    assert(utimensat(AT_FDCWD, path, times, 0) == 0);
+}
+
+static time_t mtime_of(const char* path)
+{
+    struct stat st;
+    assert(stat(path, &st) == 0);
+    return st.st_mtime;
+}
+
+static bool same_content(const char* a, const char* b)
+{
+    String_Builder x = {0}, y = {0};
+    assert(load_file_data(a, &x) && load_file_data(b, &y));
+    bool result = x.count == y.count && memcmp(x.data, y.data, x.count) == 0;
+    sb_free(&x);
+    sb_free(&y);
+    return result;
+}
+
+static void test_file_hash(void)
+{
+    char* data = malloc(BIG_SIZE);
+    for(size_t i = 0; i < BIG_SIZE; ++i) data[i] = (char)(i * 31 + (i >> 13));
+    assert(save_file_data(ROOT "/big.bin", data, BIG_SIZE));
+
+    // Hash of the chunk hashes, each chunk seeded with its index
+    uint64_t chunk_hashes[3];
+    for(size_t c = 0; c < 3; ++c) {
+        size_t offset = c * FILE_HASH_CHUNK_SIZE;
+        size_t size = BIG_SIZE - offset < FILE_HASH_CHUNK_SIZE ? BIG_SIZE - offset : FILE_HASH_CHUNK_SIZE;
+        chunk_hashes[c] = sv_hash64(sv_from_parts(data + offset, size), c);
+    }
+    uint64_t expected = sv_hash64(sv_from_parts((const char*)chunk_hashes, sizeof(chunk_hashes)), BIG_SIZE);
+
+    uint64_t hash = 0;
+    assert(file_hash64(ROOT "/big.bin", &hash));
+    assert(hash == expected);
+
+    data[BIG_SIZE - 1] ^= 1;
+    assert(save_file_data(ROOT "/big.bin", data, BIG_SIZE));
+    uint64_t changed = 0;
+    assert(file_hash64(ROOT "/big.bin", &changed));
+    assert(changed != hash);
+
+    uint64_t empty_a = 0, empty_b = 1;
+    write_file(ROOT "/empty", "");
+    assert(file_hash64(ROOT "/empty", &empty_a));
+    assert(file_hash64(ROOT "/empty", &empty_b));
+    assert(empty_a == empty_b);
+    assert(!file_hash64(ROOT "/missing", &hash));
+    free(data);
+    printf("file_hash64 ok\n");
+}
+
+static void test_copy(void)
+{
+    mkdir(ROOT "/src", 0755);
+    mkdir(ROOT "/src/sub", 0755);
+    write_file(ROOT "/src/a.txt", "alpha");
+    write_file(ROOT "/src/sub/b.txt", "bravo");
+    assert(copy_dir_recursive(ROOT "/dst", ROOT "/src"));
+    assert(same_content(ROOT "/src/a.txt", ROOT "/dst/a.txt"));
+    assert(same_content(ROOT "/src/sub/b.txt", ROOT "/dst/sub/b.txt"));
+    assert(mtime_of(ROOT "/dst/a.txt") == mtime_of(ROOT "/src/a.txt"));
+
+    // Without a cache a copy with the same size and mtime is left alone
+    write_file(ROOT "/dst/a.txt", "ALPHA");
+    set_mtime(ROOT "/src/a.txt", 1500000000);
+    set_mtime(ROOT "/dst/a.txt", 1500000000);
+    assert(copy_file(ROOT "/dst/a.txt", ROOT "/src/a.txt"));
+    assert(!same_content(ROOT "/src/a.txt", ROOT "/dst/a.txt"));
+
+    // With one the contents are compared, so the stale copy is replaced...
+    Build_Cache cache;
+    assert(build_cache_open(&cache, INDEX));
+    assert(copy_file(ROOT "/dst/a.txt", ROOT "/src/a.txt"));
+    assert(same_content(ROOT "/src/a.txt", ROOT "/dst/a.txt"));
+
+    // ...and touching the source without changing it does not copy again
+    set_mtime(ROOT "/src/sub/b.txt", 2000000000);
+    assert(copy_dir_recursive(ROOT "/dst", ROOT "/src"));
+    assert(mtime_of(ROOT "/dst/sub/b.txt") != 2000000000);
+    write_file(ROOT "/src/sub/b.txt", "BRAVO");
+    assert(copy_dir_recursive(ROOT "/dst", ROOT "/src"));
+    assert(same_content(ROOT "/src/sub/b.txt", ROOT "/dst/sub/b.txt"));
+    assert(build_cache_close(&cache));
+
+    assert(!copy_file(ROOT "/dst/missing", ROOT "/src/missing"));
+    printf("copy ok\n");
+}
+
+static void test_needs_rebuild(void)
+{
+    const char* inputs[] = { ROOT "/main.c", ROOT "/util.h" };
+    write_file(inputs[0], "int main(void) { return 0; }");
+    write_file(inputs[1], "#pragma once");
+    set_mtime(inputs[0], 1000000000);
+    set_mtime(inputs[1], 1000000000);
+
+    assert(needs_rebuild(ROOT "/main.o", inputs, 2));
+    write_file(ROOT "/main.o", "object");
+    set_mtime(ROOT "/main.o", 1000000100);
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+
+    // Without a cache touching an input is enough, a failed open leaves none behind
+    Build_Cache cache;
+    assert(!build_cache_open(&cache, ROOT "/main.c/cache.idx"));
+    assert(cache.index_path == NULL && cache.entries.count == 0);
+    set_mtime(inputs[1], 1000000200);
+    assert(needs_rebuild(ROOT "/main.o", inputs, 2));
+    set_mtime(inputs[1], 1000000000);
+
+    // The cache records the inputs while the output is up to date...
+    assert(build_cache_open(&cache, INDEX));
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+    set_mtime(inputs[1], 1000000200);
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+    assert(build_cache_close(&cache));
+
+    // ...across runs, until an input really changes
+    assert(build_cache_open(&cache, INDEX));
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+    write_file(inputs[0], "int main(void) { return 1; }");
+    set_mtime(inputs[0], 1000000050);
+    assert(needs_rebuild(ROOT "/main.o", inputs, 2));
+    assert(needs_rebuild(ROOT "/main.o", inputs, 2));
+
+    // Rebuilding the output makes it up to date again
+    write_file(ROOT "/main.o", "object 2");
+    set_mtime(ROOT "/main.o", 1000000300);
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+    assert(!needs_rebuild(ROOT "/main.o", inputs, 2));
+
+    const char* missing[] = { ROOT "/missing.c" };
+    assert(needs_rebuild(ROOT "/main.o", missing, 1));
+    assert(build_cache_close(&cache));
+    printf("needs_rebuild ok\n");
+}
+
+int main(void)
+{
+    Cmd cmd = {0};
+    cmd_append(&cmd, "rm", "-rf", ROOT);
+    assert(cmd_run_sync(&cmd));
+    assert(mkdir(ROOT, 0755) == 0);
+
+    test_file_hash();
+    test_copy();
+    test_needs_rebuild();
+
+    assert(cmd_run_sync(&cmd));
+    da_free(&cmd);
+    return 0;
+}
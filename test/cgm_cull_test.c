@@ -0,0 +1,89 @@
+#define CGM_SIMD
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Not a multiple of 8, so the scalar tail is covered too
+#define VOLUME_COUNT 10003
+
+static float xs[VOLUME_COUNT], ys[VOLUME_COUNT], zs[VOLUME_COUNT], radii[VOLUME_COUNT];
+static float exs[VOLUME_COUNT], eys[VOLUME_COUNT], ezs[VOLUME_COUNT];
+static uint8_t mask[(VOLUME_COUNT + 7) / 8];
+static uint32_t indices[VOLUME_COUNT], mask_indices[VOLUME_COUNT];
+
+static float random_float(float range)
+{
+    return ((float)rand() / (float)RAND_MAX) * 2.0f * range - range;
+}
+
+static BOOL bit(size_t i)
+{
+    return (mask[i / 8] >> (i % 8)) & 1;
+}
+
+int main(void)
+{
+    srand(69);
+
+    // Camera at (0, 0, 10) looking down -z
+    M4f view = m4f_translate(v3f(0.0f, 0.0f, -10.0f));
+    M4f projection = m4f_perspective(CGM_HALF_PI, 1.0f, 0.1f, 100.0f);
+    Cgm_Frustum f = cgm_frustum_from_m4f(m4f_dot(view, projection));
+
+    float cx[] = { 0.0f, 0.0f,  0.0f,   30.0f, 30.0f, 0.0f,    0.0f };
+    float cy[] = { 0.0f, 0.0f,  0.0f,   0.0f,  0.0f,  0.0f,    0.0f };
+    float cz[] = { 0.0f, 20.0f, 10.5f,  0.0f,  0.0f,  -200.0f, -89.5f };
+    float r[]  = { 1.0f, 1.0f,  1.0f,   1.0f,  25.0f, 1.0f,    1.0f };
+    BOOL expected[] = { TRUE, FALSE, TRUE, FALSE, TRUE, FALSE, TRUE };
+    Cgm_Spheres known = { cx, cy, cz, r };
+    size_t known_count = sizeof(cx) / sizeof(cx[0]);
+    cgm_cull_spheres_mask(&f, &known, known_count, mask);
+    for(size_t i = 0; i < known_count; ++i) assert(bit(i) == expected[i]);
+
+    Cgm_Aabbs known_boxes = { cx, cy, cz, r, r, r };
+    cgm_cull_aabbs_mask(&f, &known_boxes, known_count, mask);
+    for(size_t i = 0; i < known_count; ++i) assert(bit(i) == expected[i]);
+
+    for(size_t i = 0; i < VOLUME_COUNT; ++i) {
+        xs[i] = random_float(100.0f);
+        ys[i] = random_float(100.0f);
+        zs[i] = random_float(100.0f);
+        radii[i] = fabsf(random_float(5.0f));
+        exs[i] = fabsf(random_float(5.0f));
+        eys[i] = fabsf(random_float(5.0f));
+        ezs[i] = fabsf(random_float(5.0f));
+    }
+
+    Cgm_Spheres spheres = { xs, ys, zs, radii };
+    cgm_cull_spheres_mask(&f, &spheres, VOLUME_COUNT, mask);
+    size_t visible = 0;
+    for(size_t i = 0; i < VOLUME_COUNT; ++i) {
+        assert(bit(i) == cgm__sphere_visible(&f, xs[i], ys[i], zs[i], radii[i]));
+        visible += bit(i);
+    }
+    assert(visible > 0 && visible < VOLUME_COUNT);
+    size_t count = cgm_cull_spheres_indices(&f, &spheres, VOLUME_COUNT, indices);
+    assert(count == visible);
+    assert(cgm_mask_to_indices(mask, VOLUME_COUNT, mask_indices) == count);
+    for(size_t i = 0; i < count; ++i) {
+        assert(indices[i] == mask_indices[i]);
+        assert(bit(indices[i]));
+    }
+
+    Cgm_Aabbs aabbs = { xs, ys, zs, exs, eys, ezs };
+    cgm_cull_aabbs_mask(&f, &aabbs, VOLUME_COUNT, mask);
+    visible = 0;
+    for(size_t i = 0; i < VOLUME_COUNT; ++i) {
+        assert(bit(i) == cgm__aabb_visible(&f, xs[i], ys[i], zs[i], exs[i], eys[i], ezs[i]));
+        visible += bit(i);
+    }
+    count = cgm_cull_aabbs_indices(&f, &aabbs, VOLUME_COUNT, indices);
+    assert(count == visible);
+    for(size_t i = 0; i < count; ++i) assert(bit(indices[i]));
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#define CGM_FAST_MATH
+#define CGM_SIMD
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+// The bounds documented next to `CGM_FAST_MATH` in cgm.h
+#if CGM_FAST_MATH_SSE
+    #define RSQRT_MAX_RELATIVE_ERROR 3e-7
+#else
+    #define RSQRT_MAX_RELATIVE_ERROR 1.8e-3
+#endif
+#define SINCOS_MAX_ABSOLUTE_ERROR 1e-7
+#define SINCOS_RANGE 8192.0f
+#define ANGLE_COUNT (1024*1024)
+
+static float angles[ANGLE_COUNT], sins[ANGLE_COUNT], coss[ANGLE_COUNT];
+
+int main(void)
+{
+    double rsqrt_error = 0.0;
+    for(float x = 1e-6f; x < 1e6f; x *= 1.0001f) {
+        double expected = 1.0 / sqrt((double)x);
+        double error = fabs((double)cgm_rsqrtf(x) - expected) / expected;
+        if(error > rsqrt_error) rsqrt_error = error;
+    }
+    printf("cgm_rsqrtf     max relative error: %g\n", rsqrt_error);
+    assert(rsqrt_error <= RSQRT_MAX_RELATIVE_ERROR);
+
+    double sincos_error = 0.0;
+    for(size_t i = 0; i < ANGLE_COUNT; ++i) {
+        angles[i] = -SINCOS_RANGE + 2.0f * SINCOS_RANGE * (float)i / (float)ANGLE_COUNT;
+        float s, c;
+        cgm_sincosf(angles[i], &s, &c);
+        double es = fabs((double)s - sin((double)angles[i]));
+        double ec = fabs((double)c - cos((double)angles[i]));
+        if(es > sincos_error) sincos_error = es;
+        if(ec > sincos_error) sincos_error = ec;
+    }
+    printf("cgm_sincosf    max absolute error: %g\n", sincos_error);
+    assert(sincos_error <= SINCOS_MAX_ABSOLUTE_ERROR);
+
+    // The batch version has to agree with libm as well, whichever path it takes
+    double batch_error = 0.0;
+    cgm_sincosf_n(angles, sins, coss, ANGLE_COUNT);
+    for(size_t i = 0; i < ANGLE_COUNT; ++i) {
+        double es = fabs((double)sins[i] - sin((double)angles[i]));
+        double ec = fabs((double)coss[i] - cos((double)angles[i]));
+        if(es > batch_error) batch_error = es;
+        if(ec > batch_error) batch_error = ec;
+    }
+    printf("cgm_sincosf_n  max absolute error: %g\n", batch_error);
+    assert(batch_error <= SINCOS_MAX_ABSOLUTE_ERROR);
+
+    V3f n3 = v3f_normalize(v3f(3.0f, 4.0f, 12.0f));
+    assert(fabsf(v3f_length(n3) - 1.0f) <= 1e-6f);
+    V4f n4 = v4f_normalize(v4f(1.0f, 2.0f, 3.0f, 4.0f));
+    assert(fabsf(v4f_length(n4) - 1.0f) <= 1e-6f);
+
+    // Rotating the x axis by a quarter turn around z lands on y
+    V3f y = v3f_transform_point(v3f(1.0f, 0.0f, 0.0f), m4f_rotate_z(CGM_HALF_PI));
+    assert(fabsf(y.x) <= 1e-6f && fabsf(y.y - 1.0f) <= 1e-6f && fabsf(y.z) <= 1e-6f);
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "../cgm.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+using namespace cgm;
+
+#define TEST_EPSILON 1e-5f
+
+static bool close_enough(float a, float b)
+{
+    float magnitude = std::fabs(b) < 1.0f ? 1.0f : std::fabs(b);
+    return std::fabs(a - b) <= TEST_EPSILON * magnitude;
+}
+
+static bool mat4_close_enough(const mat4& a, const M4f& b)
+{
+    for(int i = 0; i < 16; ++i) {
+        if(!close_enough(a.elements[i], b.elements[i])) return false;
+    }
+    return true;
+}
+
+// Folded by the compiler, a failure here is a build error
+constexpr vec3 a(1.0f, 2.0f, 3.0f);
+constexpr vec3 b(4.0f, 5.0f, 6.0f);
+constexpr vec3 fused = a*b + b*2.0f - a;
+static_assert(fused == vec3(11.0f, 18.0f, 27.0f));
+static_assert(dot(a, b) == 32.0f);
+static_assert(eval(-a) == vec3(-1.0f, -2.0f, -3.0f));
+static_assert(cross(vec3(1, 0, 0), vec3(0, 1, 0)) == vec3(0, 0, 1));
+static_assert(length(vec2(3.0f, 4.0f)) == 5.0f);
+
+constexpr mat4 projection = mat4::perspective(CGM_HALF_PI, 16.0f / 9.0f, 0.1f, 100.0f);
+static_assert(projection.elements[11] == -1.0f);
+static_assert(projection.elements[5] > 0.9999f && projection.elements[5] < 1.0001f); // 1 / tan(pi/4)
+constexpr mat4 model = mat4::scale(vec3(2, 2, 2)) * mat4::translate(vec3(1, 2, 3));
+static_assert(transform_point(vec3(1, 1, 1), model) == vec3(3, 4, 5));
+
+constexpr vec3 compound()
+{
+    vec3 v(1.0f, 1.0f, 1.0f);
+    v += a * 2.0f;
+    v *= 0.5f;
+    return v;
+}
+static_assert(compound() == vec3(1.5f, 2.5f, 3.5f));
+
+int main(void)
+{
+    // Runtime values against the C implementation
+    M4f c_projection = m4f_perspective(CGM_HALF_PI, 16.0f / 9.0f, 0.1f, 100.0f);
+    assert(mat4_close_enough(projection, c_projection));
+    assert(mat4_close_enough(mat4::ortho(-1, 2, -3, 4, 0.5f, 50.0f), m4f_ortho(-1, 2, -3, 4, 0.5f, 50.0f)));
+
+    constexpr vec3 angles(0.3f, -1.2f, 2.5f);
+    constexpr mat4 rotation = mat4::rotate(angles);
+    assert(mat4_close_enough(rotation, m4f_rotate(to_c(angles))));
+    volatile float runtime_angle = 0.7f;
+    assert(mat4_close_enough(mat4::rotate_y(runtime_angle), m4f_rotate_y(0.7f)));
+
+    mat4 combined = rotation * model * projection;
+    M4f c_combined = m4f_dot(m4f_dot(to_c(rotation), to_c(model)), c_projection);
+    assert(mat4_close_enough(combined, c_combined));
+    assert(mat4_close_enough(combined.transposed().transposed(), c_combined));
+
+    volatile float runtime_scale = 3.0f;
+    vec4 v(1.0f, -2.0f, 0.5f, 1.0f);
+    vec4 w(runtime_scale, 1.0f, 2.0f, 0.0f);
+    vec4 r = v*w + w*runtime_scale - v / w.x;
+    V4f c_r = v4f_sub(v4f_add(v4f_mul(to_c(v), to_c(w)), v4f_mul(to_c(w), v4f(3, 3, 3, 3))), v4f_div(to_c(v), v4f(3, 3, 3, 3)));
+    for(int i = 0; i < 4; ++i) assert(close_enough(r[i], c_r.elements[i]));
+
+    vec4 t = v * combined;
+    V4f c_t = v4f_transform(to_c(v), c_combined);
+    for(int i = 0; i < 4; ++i) assert(close_enough(t[i], c_t.elements[i]));
+
+    vec3 n = normalize(vec3(runtime_scale, 4.0f, 0.0f));
+    assert(close_enough(n.x, 0.6f) && close_enough(n.y, 0.8f));
+    assert(close_enough(distance(a, b), v3f_distance(to_c(a), to_c(b))));
+
+    // Same memory as the C types, arrays go to the batch functions as they are
+    vec3 points[5] = { vec3(0, 0, 0), vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1), vec3(1, 2, 3) };
+    vec3 moved[5];
+    mat4 m = mat4::rotate(angles) * mat4::translate(vec3(1, 2, 3));
+    cgm_transform_v3f(as_c(&m), as_c(points), as_c(moved), 5);
+    for(int i = 0; i < 5; ++i) {
+        vec3 expected = transform_point(points[i], m);
+        for(int j = 0; j < 3; ++j) assert(close_enough(moved[i][j], expected[j]));
+    }
+    assert(from_c(to_c(m)) == m);
+
+    printf("OK\n");
+    return 0;
+}
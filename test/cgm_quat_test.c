@@ -0,0 +1,121 @@
+#define CGM_SIMD
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ITERATIONS 10000
+#define TEST_EPSILON 1e-4f
+#define JOINT_COUNT 4096
+
+static Qf pose_a[JOINT_COUNT], pose_b[JOINT_COUNT], blended[JOINT_COUNT];
+static M4f matrices[JOINT_COUNT];
+
+static float random_float(void)
+{
+    return ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+}
+
+static Qf random_qf(void)
+{
+    V3f axis = v3f_normalize(v3f(random_float(), random_float(), random_float()));
+    return qf_from_axis_angle(axis, random_float() * 3.14159265f);
+}
+
+static BOOL close_enough(float a, float b)
+{
+    return fabsf(a - b) <= TEST_EPSILON;
+}
+
+static BOOL qf_close_enough(Qf a, Qf b)
+{
+    // q and -q are the same rotation
+    float sign = qf_dot(a, b) < 0.0f ? -1.0f : 1.0f;
+    for(int i = 0; i < 4; ++i) {
+        if(!close_enough(a.elements[i], sign * b.elements[i])) return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL v3f_close_enough(V3f a, V3f b)
+{
+    return close_enough(a.x, b.x) && close_enough(a.y, b.y) && close_enough(a.z, b.z);
+}
+
+static BOOL m4f_close_enough(M4f a, M4f b)
+{
+    for(int i = 0; i < 16; ++i) {
+        if(!close_enough(a.elements[i], b.elements[i])) return FALSE;
+    }
+    return TRUE;
+}
+
+// Half angle of the rotation from a to b, atan2 stays accurate where acos of a dot does not
+static float angle_between(Qf a, Qf b)
+{
+    Qf d = qf_mul(qf_conjugate(a), b);
+    float v = sqrtf(d.x*d.x + d.y*d.y + d.z*d.z);
+    return atan2f(v, fabsf(d.w));
+}
+
+int main(void)
+{
+    srand(69);
+
+    // Same handedness as the Euler matrices
+    for(int n = 0; n < 64; ++n) {
+        float angle = random_float() * 3.0f;
+        assert(m4f_close_enough(qf_to_m4f(qf_from_axis_angle(v3f(1, 0, 0), angle)), m4f_rotate_x(angle)));
+        assert(m4f_close_enough(qf_to_m4f(qf_from_axis_angle(v3f(0, 1, 0), angle)), m4f_rotate_y(angle)));
+        assert(m4f_close_enough(qf_to_m4f(qf_from_axis_angle(v3f(0, 0, 1), angle)), m4f_rotate_z(angle)));
+    }
+
+    for(int n = 0; n < TEST_ITERATIONS; ++n) {
+        Qf a = random_qf();
+        Qf b = random_qf();
+        V3f v = v3f(random_float(), random_float(), random_float());
+
+        assert(v3f_close_enough(qf_rotate_v3f(a, v), v3f_transform_point(v, qf_to_m4f(a))));
+        assert(v3f_close_enough(qf_rotate_v3f(qf_mul(a, b), v), qf_rotate_v3f(a, qf_rotate_v3f(b, v))));
+        assert(m4f_close_enough(qf_to_m4f(qf_mul(a, b)), m4f_dot(qf_to_m4f(b), qf_to_m4f(a))));
+        assert(qf_close_enough(qf_mul(a, qf_conjugate(a)), qf_identity()));
+
+        assert(qf_close_enough(qf_slerp(a, b, 0.0f), a));
+        assert(qf_close_enough(qf_slerp(a, b, 1.0f), b));
+        assert(qf_close_enough(qf_nlerp(a, b, 0.0f), a));
+        assert(qf_close_enough(qf_nlerp(a, b, 1.0f), b));
+
+        // Slerp moves at constant speed, half way is the midpoint of the arc
+        float t = (random_float() + 1.0f) * 0.5f;
+        Qf s = qf_slerp(a, b, t);
+        float total = angle_between(a, b);
+        float travelled = angle_between(a, s);
+        assert(fabsf(travelled - t * total) < 1e-4f);
+        assert(fabsf(qf_dot(s, s) - 1.0f) < 1e-5f);
+
+        // Small angles take the nlerp path without a discontinuity
+        Qf near = qf_normalize(qf(a.x + 1e-3f, a.y, a.z, a.w));
+        assert(qf_close_enough(qf_slerp(a, near, t), qf_nlerp(a, near, t)));
+    }
+
+    for(size_t i = 0; i < JOINT_COUNT; ++i) {
+        pose_a[i] = random_qf();
+        pose_b[i] = random_qf();
+    }
+    qf_nlerp_n(pose_a, pose_b, 0.3f, blended, JOINT_COUNT);
+    for(size_t i = 0; i < JOINT_COUNT; ++i) assert(qf_close_enough(blended[i], qf_nlerp(pose_a[i], pose_b[i], 0.3f)));
+    // A count that leaves a tail after both the 8 and the 4 wide loops
+    blended[JOINT_COUNT - 1] = qf(0.0f, 0.0f, 0.0f, 0.0f);
+    qf_nlerp_n(pose_a, pose_b, 0.6f, blended, JOINT_COUNT - 3);
+    for(size_t i = 0; i < JOINT_COUNT - 3; ++i) assert(qf_close_enough(blended[i], qf_nlerp(pose_a[i], pose_b[i], 0.6f)));
+    assert(blended[JOINT_COUNT - 1].w == 0.0f);
+    qf_slerp_n(pose_a, pose_b, 0.7f, blended, JOINT_COUNT);
+    for(size_t i = 0; i < JOINT_COUNT; ++i) assert(qf_close_enough(blended[i], qf_slerp(pose_a[i], pose_b[i], 0.7f)));
+    qf_to_m4f_n(blended, matrices, JOINT_COUNT);
+    for(size_t i = 0; i < JOINT_COUNT; ++i) assert(m4f_close_enough(matrices[i], qf_to_m4f(blended[i])));
+
+    printf("OK\n");
+    return 0;
+}
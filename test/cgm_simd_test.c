@@ -0,0 +1,147 @@
+#define CGM_SIMD
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ITERATIONS 10000
+#define TEST_EPSILON 1e-5f
+
+static float random_float(void)
+{
+    return ((float)rand() / (float)RAND_MAX) * 200.0f - 100.0f;
+}
+
+static V4f random_v4f(void)
+{
+    return v4f(random_float(), random_float(), random_float(), random_float());
+}
+
+// Sums can cancel, so the error is measured against the magnitude of the terms
+static BOOL close_enough(float a, float b, float magnitude)
+{
+    if(magnitude < 1.0f) magnitude = 1.0f;
+    return fabsf(a - b) <= TEST_EPSILON * magnitude;
+}
+
+static BOOL v4f_close_enough(V4f a, V4f b)
+{
+    for(int i = 0; i < 4; ++i) {
+        if(!close_enough(a.elements[i], b.elements[i], fabsf(b.elements[i]))) return FALSE;
+    }
+    return TRUE;
+}
+
+static float dot_magnitude(V4f a, V4f b)
+{
+    return fabsf(a.x*b.x) + fabsf(a.y*b.y) + fabsf(a.z*b.z) + fabsf(a.w*b.w);
+}
+
+// Relative to the expected element, inverse translations get large
+static BOOL m4f_close_enough(M4f a, M4f b, float epsilon)
+{
+    for(int i = 0; i < 16; ++i) {
+        float magnitude = fabsf(b.elements[i]) < 1.0f ? 1.0f : fabsf(b.elements[i]);
+        if(fabsf(a.elements[i] - b.elements[i]) > epsilon * magnitude) return FALSE;
+    }
+    return TRUE;
+}
+
+static M4f random_rigid(void)
+{
+    V3f angles = v3f(random_float() * 0.05f, random_float() * 0.05f, random_float() * 0.05f);
+    V3f position = v3f(random_float() * 0.1f, random_float() * 0.1f, random_float() * 0.1f);
+    return m4f_dot(m4f_rotate(angles), m4f_translate(position));
+}
+
+int main(void)
+{
+    printf("backend: %s\n", CGM_SIMD_AVX ? "avx" : CGM_SIMD_SSE ? "sse4.1" : CGM_SIMD_NEON ? "neon" : "scalar");
+    assert(_Alignof(V4f) == 16 && _Alignof(M4f) == 16);
+
+    srand(69);
+    for(int n = 0; n < TEST_ITERATIONS; ++n) {
+        V4f a = random_v4f();
+        V4f b = random_v4f();
+        assert(v4f_close_enough(v4f_add(a, b), cgm__v4f_add_scalar(a, b)));
+        assert(v4f_close_enough(v4f_sub(a, b), cgm__v4f_sub_scalar(a, b)));
+        assert(v4f_close_enough(v4f_mul(a, b), cgm__v4f_mul_scalar(a, b)));
+        assert(v4f_close_enough(v4f_div(a, b), cgm__v4f_div_scalar(a, b)));
+        assert(close_enough(v4f_dot(a, b), cgm__v4f_dot_scalar(a, b), dot_magnitude(a, b)));
+        assert(close_enough(v4f_length(a), sqrtf(cgm__v4f_dot_scalar(a, a)), v4f_length(a)));
+        assert(v4f_close_enough(v4f_normalize(a), cgm__v4f_normalize_scalar(a)));
+
+        M4f ma, mb;
+        for(int i = 0; i < 16; ++i) {
+            ma.elements[i] = random_float();
+            mb.elements[i] = random_float();
+        }
+        M4f expected = cgm__m4f_dot_scalar(&ma, &mb);
+        M4f got = m4f_dot(ma, mb);
+        for(int i = 0; i < 4; ++i) {
+            for(int j = 0; j < 4; ++j) {
+                float magnitude = 0.0f;
+                for(int k = 0; k < 4; ++k) magnitude += fabsf(ma.elements[i*4 + k] * mb.elements[k*4 + j]);
+                assert(close_enough(got.elements[i*4 + j], expected.elements[i*4 + j], magnitude));
+            }
+        }
+    }
+
+    for(int n = 0; n < TEST_ITERATIONS; ++n) {
+        V3f angles = v3f(random_float() * 0.05f, random_float() * 0.05f, random_float() * 0.05f);
+        M4f expected = m4f_dot(m4f_dot(m4f_rotate_x(angles.x), m4f_rotate_y(angles.y)), m4f_rotate_z(angles.z));
+        assert(m4f_close_enough(m4f_rotate(angles), expected, 1e-5f));
+
+        M4f rigid = random_rigid();
+        V3f scale = v3f(0.5f + fabsf(random_float()) * 0.02f, 0.5f + fabsf(random_float()) * 0.02f, 0.5f + fabsf(random_float()) * 0.02f);
+        M4f affine = m4f_dot(m4f_scale(scale), random_rigid());
+        M4f general = affine;
+        general.elements[3] = random_float() * 0.0001f;
+        general.elements[7] = random_float() * 0.0001f;
+
+        M4f identity = m4f(1.0f);
+        assert(m4f_close_enough(m4f_dot(general, m4f_inverse(general)), identity, 1e-3f));
+        assert(m4f_close_enough(m4f_inverse(general), cgm__m4f_inverse_scalar(&general), 1e-3f));
+        assert(m4f_close_enough(m4f_inverse_affine(affine), m4f_inverse(affine), 1e-3f));
+        assert(m4f_close_enough(m4f_inverse_rigid(rigid), m4f_inverse(rigid), 1e-3f));
+        assert(m4f_close_enough(m4f_dot(affine, m4f_inverse_affine(affine)), identity, 1e-3f));
+        assert(m4f_close_enough(m4f_mul_affine(affine, rigid), m4f_dot(affine, rigid), 1e-3f));
+
+        M4f t = m4f_transpose(general);
+        for(int i = 0; i < 4; ++i) {
+            for(int j = 0; j < 4; ++j) {
+                assert(t.elements[i*4 + j] == general.elements[j*4 + i]);
+            }
+        }
+    }
+
+    // Projections have a zero w diagonal and large translations put most of
+    // the magnitude in the bottom row, away from where a pivot would be
+    for(int n = 0; n < TEST_ITERATIONS; ++n) {
+        float fov = 0.5f + fabsf(random_float()) * 0.02f;
+        float aspect = 0.5f + fabsf(random_float()) * 0.02f;
+        float near = 0.01f + fabsf(random_float()) * 0.01f;
+        M4f projection = m4f_perspective(fov, aspect, near, near + 10.0f + fabsf(random_float()) * 10.0f);
+        M4f view_projection = m4f_dot(random_rigid(), projection);
+
+        M4f translated = m4f_dot(m4f_scale(v3f(2.0f, 0.5f, 1.0f)), random_rigid());
+        translated.elements[12] = random_float() * 10.0f;
+        translated.elements[13] = random_float() * 10.0f;
+        translated.elements[14] = random_float() * 10.0f;
+        translated.elements[15] = 1.0f + fabsf(random_float()) * 10.0f;
+
+        M4f identity = m4f(1.0f);
+        M4f matrices[] = { projection, view_projection, translated };
+        for(size_t i = 0; i < sizeof(matrices) / sizeof(matrices[0]); ++i) {
+            M4f inverse = m4f_inverse(matrices[i]);
+            assert(m4f_close_enough(inverse, cgm__m4f_inverse_scalar(&matrices[i]), 1e-3f));
+            assert(m4f_close_enough(m4f_dot(matrices[i], inverse), identity, 1e-3f));
+            assert(m4f_close_enough(m4f_dot(inverse, matrices[i]), identity, 1e-3f));
+        }
+    }
+
+    printf("OK\n");
+    return 0;
+}
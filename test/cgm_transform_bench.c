@@ -0,0 +1,119 @@
+#define CGM_SIMD
+#define CGM_THREADS
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// One size that stays in L2 and one that streams from memory
+#define SMALL_POINT_COUNT (16*1024)
+#define LARGE_POINT_COUNT (4*1024*1024)
+#define TOTAL_POINTS (64*1024*1024)
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, double seconds, size_t n, int repeat)
+{
+    double per_batch = seconds / repeat;
+    printf("%-28s %8.3f ms/batch %8.1f Mpoints/s\n", name, per_batch * 1e3, (double)n / per_batch * 1e-6);
+}
+
+static float max_error_v3f(const V3f* a, const V3f* b, size_t n)
+{
+    float result = 0.0f;
+    for(size_t i = 0; i < n; ++i) {
+        for(int k = 0; k < 3; ++k) {
+            float d = fabsf(a[i].elements[k] - b[i].elements[k]);
+            if(d > result) result = d;
+        }
+    }
+    return result;
+}
+
+static void bench(size_t n)
+{
+    int repeat = (int)(TOTAL_POINTS / n);
+    M4f m = {0};
+    for(int i = 0; i < 16; ++i) m.elements[i] = (float)(i % 5) * 0.25f - 0.5f;
+    m.elements[15] = 1.0f;
+
+    V3f* points = malloc(n * sizeof(V3f));
+    V3f* expected = malloc(n * sizeof(V3f));
+    V3f* got = malloc(n * sizeof(V3f));
+    V4f* vectors = malloc(n * sizeof(V4f));
+    V4f* vectors_out = malloc(n * sizeof(V4f));
+    float* xs = malloc(n * sizeof(float));
+    float* ys = malloc(n * sizeof(float));
+    float* zs = malloc(n * sizeof(float));
+    float* out_xs = malloc(n * sizeof(float));
+    float* out_ys = malloc(n * sizeof(float));
+    float* out_zs = malloc(n * sizeof(float));
+    assert(points && expected && got && vectors && vectors_out && xs && ys && zs && out_xs && out_ys && out_zs);
+
+    srand(69);
+    for(size_t i = 0; i < n; ++i) {
+        points[i] = v3f((float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
+        vectors[i] = v4f(points[i].x, points[i].y, points[i].z, 1.0f);
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+        zs[i] = points[i].z;
+    }
+
+    printf("%zu points, backend: %s\n", n, CGM_SIMD_AVX ? "avx" : CGM_SIMD_SSE ? "sse4.1" : "scalar");
+
+    double start = now_seconds();
+    for(int r = 0; r < repeat; ++r) {
+        for(size_t i = 0; i < n; ++i) expected[i] = v3f_transform_point(points[i], m);
+    }
+    report("scalar v3f_transform_point", now_seconds() - start, n, repeat);
+
+    start = now_seconds();
+    for(int r = 0; r < repeat; ++r) cgm_transform_v3f(&m, points, got, n);
+    report("cgm_transform_v3f (AoS)", now_seconds() - start, n, repeat);
+    assert(max_error_v3f(got, expected, n) < 1e-5f);
+
+    start = now_seconds();
+    for(int r = 0; r < repeat; ++r) cgm_transform_points(&m, xs, ys, zs, out_xs, out_ys, out_zs, n);
+    report("cgm_transform_points (SoA)", now_seconds() - start, n, repeat);
+    for(size_t i = 0; i < n; ++i) got[i] = v3f(out_xs[i], out_ys[i], out_zs[i]);
+    assert(max_error_v3f(got, expected, n) < 1e-5f);
+
+    start = now_seconds();
+    for(int r = 0; r < repeat; ++r) {
+        for(size_t i = 0; i < n; ++i) vectors_out[i] = v4f_transform(vectors[i], m);
+    }
+    report("scalar v4f_transform", now_seconds() - start, n, repeat);
+
+    start = now_seconds();
+    for(int r = 0; r < repeat; ++r) cgm_transform_v4f(&m, vectors, vectors_out, n);
+    report("cgm_transform_v4f (AoS)", now_seconds() - start, n, repeat);
+    for(size_t i = 0; i < n; ++i) got[i] = v3f(vectors_out[i].x, vectors_out[i].y, vectors_out[i].z);
+    assert(max_error_v3f(got, expected, n) < 1e-5f);
+
+    free(points);
+    free(expected);
+    free(got);
+    free(vectors);
+    free(vectors_out);
+    free(xs);
+    free(ys);
+    free(zs);
+    free(out_xs);
+    free(out_ys);
+    free(out_zs);
+}
+
+int main(void)
+{
+    bench(SMALL_POINT_COUNT);
+    bench(LARGE_POINT_COUNT);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#define CGM_SIMD
+#define CGM_THREADS
+#define CGM_IMPLEMENTATION
+#include "../cgm.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_EPSILON 1e-5f
+// Outputs of this many points and more go through the non-temporal stores
+#define STREAM_POINT_COUNT (CGM_STREAM_THRESHOLD / (3 * sizeof(float)) + 3)
+
+static float random_float(void)
+{
+    return ((float)rand() / (float)RAND_MAX) * 200.0f - 100.0f;
+}
+
+static BOOL close_enough(float a, float b, float magnitude)
+{
+    if(magnitude < 1.0f) magnitude = 1.0f;
+    return fabsf(a - b) <= TEST_EPSILON * magnitude;
+}
+
+// The sum of the absolute terms bounds the rounding of every kernel
+static float magnitude_of(V4f v, const M4f* m, int j)
+{
+    return fabsf(v.x*m->elements[j]) + fabsf(v.y*m->elements[4 + j])
+        + fabsf(v.z*m->elements[8 + j]) + fabsf(v.w*m->elements[12 + j]);
+}
+
+// The outputs share one allocation, `stride` floats apart so they keep the same
+// alignment: streaming only kicks in when all three can reach 32 bytes together
+static void check_points(const M4f* m, size_t n, BOOL in_place, size_t xy_offset, size_t z_offset)
+{
+    size_t stride = (n + 8 + 7) & ~(size_t)7;
+    float* xs = malloc((n + 1) * sizeof(float));
+    float* ys = malloc((n + 1) * sizeof(float));
+    float* zs = malloc((n + 1) * sizeof(float));
+    float* out = malloc(3 * stride * sizeof(float));
+    V3f* expected = malloc((n + 1) * sizeof(V3f));
+    for(size_t i = 0; i < n; ++i) {
+        xs[i] = random_float();
+        ys[i] = random_float();
+        zs[i] = random_float();
+        expected[i] = v3f_transform_point(v3f(xs[i], ys[i], zs[i]), *m);
+    }
+    float* out_xs = in_place ? xs : out + xy_offset;
+    float* out_ys = in_place ? ys : out + stride + xy_offset;
+    float* out_zs = in_place ? zs : out + 2 * stride + z_offset;
+    // Remember the inputs for the magnitudes before an in-place run overwrites them
+    V3f* inputs = malloc((n + 1) * sizeof(V3f));
+    for(size_t i = 0; i < n; ++i) inputs[i] = v3f(xs[i], ys[i], zs[i]);
+
+    cgm_transform_points(m, xs, ys, zs, out_xs, out_ys, out_zs, n);
+    for(size_t i = 0; i < n; ++i) {
+        V4f p = v4f(inputs[i].x, inputs[i].y, inputs[i].z, 1.0f);
+        assert(close_enough(out_xs[i], expected[i].x, magnitude_of(p, m, 0)));
+        assert(close_enough(out_ys[i], expected[i].y, magnitude_of(p, m, 1)));
+        assert(close_enough(out_zs[i], expected[i].z, magnitude_of(p, m, 2)));
+    }
+    free(inputs);
+    free(expected);
+    free(out);
+    free(zs);
+    free(ys);
+    free(xs);
+}
+
+static void check_v3f(const M4f* m, size_t n, BOOL in_place)
+{
+    V3f* points = malloc((n + 1) * sizeof(V3f));
+    V3f* expected = malloc((n + 1) * sizeof(V3f));
+    V3f* magnitudes = malloc((n + 1) * sizeof(V3f));
+    V3f* out = in_place ? points : malloc((n + 1) * sizeof(V3f));
+    for(size_t i = 0; i < n + 1; ++i) points[i] = v3f(random_float(), random_float(), random_float());
+    for(size_t i = 0; i < n; ++i) {
+        expected[i] = v3f_transform_point(points[i], *m);
+        V4f p = v4f(points[i].x, points[i].y, points[i].z, 1.0f);
+        magnitudes[i] = v3f(magnitude_of(p, m, 0), magnitude_of(p, m, 1), magnitude_of(p, m, 2));
+    }
+    V3f sentinel = points[n];
+    if(!in_place) out[n] = sentinel;
+
+    cgm_transform_v3f(m, points, out, n);
+    for(size_t i = 0; i < n; ++i) {
+        assert(close_enough(out[i].x, expected[i].x, magnitudes[i].x));
+        assert(close_enough(out[i].y, expected[i].y, magnitudes[i].y));
+        assert(close_enough(out[i].z, expected[i].z, magnitudes[i].z));
+    }
+    // The AoS kernel must not write past the last point
+    assert(memcmp(&out[n], &sentinel, sizeof(sentinel)) == 0);
+    if(!in_place) free(out);
+    free(magnitudes);
+    free(expected);
+    free(points);
+}
+
+static void check_v4f(const M4f* m, size_t n, BOOL in_place)
+{
+    V4f* vectors = malloc((n + 1) * sizeof(V4f));
+    V4f* expected = malloc((n + 1) * sizeof(V4f));
+    V4f* magnitudes = malloc((n + 1) * sizeof(V4f));
+    V4f* out = in_place ? vectors : malloc((n + 1) * sizeof(V4f));
+    for(size_t i = 0; i < n + 1; ++i) vectors[i] = v4f(random_float(), random_float(), random_float(), random_float());
+    for(size_t i = 0; i < n; ++i) {
+        expected[i] = v4f_transform(vectors[i], *m);
+        for(int j = 0; j < 4; ++j) magnitudes[i].elements[j] = magnitude_of(vectors[i], m, j);
+    }
+    V4f sentinel = vectors[n];
+    if(!in_place) out[n] = sentinel;
+
+    cgm_transform_v4f(m, vectors, out, n);
+    for(size_t i = 0; i < n; ++i) {
+        for(int j = 0; j < 4; ++j) assert(close_enough(out[i].elements[j], expected[i].elements[j], magnitudes[i].elements[j]));
+    }
+    assert(memcmp(&out[n], &sentinel, sizeof(sentinel)) == 0);
+    if(!in_place) free(out);
+    free(magnitudes);
+    free(expected);
+    free(vectors);
+}
+
+int main(void)
+{
+    printf("backend: %s\n", CGM_SIMD_AVX ? "avx" : CGM_SIMD_SSE ? "sse4.1" : CGM_SIMD_NEON ? "neon" : "scalar");
+    srand(69);
+    M4f m;
+    for(int i = 0; i < 16; ++i) m.elements[i] = random_float() * 0.01f;
+
+    // Every tail length of the 16, 8 and 4 wide loops, a long odd batch, and
+    // one whose output streams past the caches
+    const size_t counts[] = { 0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 10003, STREAM_POINT_COUNT };
+    for(size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        size_t n = counts[c];
+        for(int in_place = 0; in_place < 2; ++in_place) {
+            check_points(&m, n, (BOOL)in_place, 0, 0);
+            check_v3f(&m, n, (BOOL)in_place);
+            check_v4f(&m, n, (BOOL)in_place);
+        }
+        // Outputs one float off 32 byte alignment, then off from each other
+        check_points(&m, n, FALSE, 1, 1);
+        check_points(&m, n, FALSE, 1, 2);
+    }
+    printf("OK\n");
+    return 0;
+}
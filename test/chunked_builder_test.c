@@ -0,0 +1,133 @@
+#define ARENA_IMPLEMENTATION
+#define COMMON_IMPLEMENTATION
+#define CHUNKED_BUILDER_IMPLEMENTATION
+#include "../chunked_builder.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#define OUTPUT_PATH "/tmp/chunked_builder_test.txt"
+#define LINE_COUNT 20000
+
+// Same output through a plain String_Builder to compare against
+static void build(Chunked_String_Builder* sb, String_Builder* expected)
+{
+    char line[128];
+    for(int i = 0; i < LINE_COUNT; ++i) {
+        int n = snprintf(line, sizeof(line), "%d,%s,%d\n", i, i % 3 ? "foo" : "a somewhat longer field", i * 7);
+        da_append_many(expected, line, n);
+        if(i % 2) sb_chunked_appendf(sb, "%d,%s,%d\n", i, i % 3 ? "foo" : "a somewhat longer field", i * 7);
+        else sb_chunked_append(sb, line, n);
+    }
+}
+
+typedef struct {
+    int fd;
+    String_Builder received;
+} Pipe_Reader;
+
+// Drains the pipe in small, slow reads so the writer keeps finding it full
+static void* pipe_reader(void* arg)
+{
+    Pipe_Reader* r = arg;
+    char buffer[1000];
+    for(int reads = 0;; ++reads) {
+        if(reads % 16 == 0) sched_yield();
+        ssize_t n = read(r->fd, buffer, sizeof(buffer));
+        assert(n >= 0);
+        if(n == 0) return NULL;
+        da_append_many(&r->received, buffer, (size_t)n);
+    }
+}
+
+// A non-blocking pipe with a small buffer takes each writev() of more than its
+// size in short writes that end mid-chunk, or fails it with EAGAIN
+static void test_flush_to_pipe(Arena* arena)
+{
+    Chunked_String_Builder sb;
+    sb_chunked_init(&sb, arena, 1000);
+    String_Builder expected = {0};
+    build(&sb, &expected);
+
+    int fds[2];
+    assert(pipe(fds) == 0);
+#ifdef F_SETPIPE_SZ
+    fcntl(fds[1], F_SETPIPE_SZ, 4096);
+#endif
+    assert(fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK) == 0);
+
+    Pipe_Reader reader = { .fd = fds[0] };
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, pipe_reader, &reader) == 0);
+    assert(sb_flush_to_fd(&sb, fds[1]));
+    close(fds[1]);
+    pthread_join(thread, NULL);
+    close(fds[0]);
+
+    assert(reader.received.count == expected.count);
+    assert(memcmp(reader.received.data, expected.data, expected.count) == 0);
+    sb_free(&reader.received);
+    sb_free(&expected);
+    printf("sb_flush_to_fd into a pipe ok\n");
+}
+
+int main(void)
+{
+    Arena arena = {0};
+
+    // Tiny chunks: appends straddle chunks and one flush needs several writev() calls
+    Chunked_String_Builder sb;
+    sb_chunked_init(&sb, &arena, 16);
+    String_Builder expected = {0};
+    sb_chunked_append_cstr(&sb, "header\n");
+    da_append_many(&expected, "header\n", 7);
+    const char* first_data = sb.first->data;
+    build(&sb, &expected);
+    assert(sb.first->data == first_data && memcmp(first_data, "header\n", 7) == 0);
+    assert(sb.count == expected.count);
+
+    size_t chunk_count = 0;
+    for(String_Chunk* c = sb.first; c != NULL; c = c->next) chunk_count += 1;
+    assert(chunk_count > 1000);
+
+    // A big append and a big format get a chunk of their own
+    char big[1000];
+    memset(big, 'x', sizeof(big));
+    sb_chunked_append(&sb, big, sizeof(big));
+    da_append_many(&expected, big, sizeof(big));
+    sb_chunked_appendf(&sb, "%.*s|", (int)sizeof(big), big);
+    da_append_many(&expected, big, sizeof(big));
+    da_append(&expected, '|');
+    assert(sb.count == expected.count);
+
+    String_View flat = sb_flatten(&sb, &arena);
+    assert(flat.count == expected.count);
+    assert(memcmp(flat.data, expected.data, flat.count) == 0);
+    assert(flat.data[flat.count] == '\0');
+    printf("chunked builder ok (%zu chunks)\n", chunk_count);
+
+    int fd = open(OUTPUT_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    assert(sb_flush_to_fd(&sb, fd));
+    close(fd);
+    String_Builder written = {0};
+    assert(load_file_data(OUTPUT_PATH, &written));
+    assert(written.count == expected.count);
+    assert(memcmp(written.data, expected.data, written.count) == 0);
+    remove(OUTPUT_PATH);
+    printf("sb_flush_to_fd ok\n");
+    test_flush_to_pipe(&arena);
+
+    // Default chunks, and an empty builder flushes nothing
+    Chunked_String_Builder empty;
+    sb_chunked_init(&empty, &arena, 0);
+    assert(empty.chunk_size == SB_CHUNK_DEFAULT_SIZE);
+    assert(sb_flush_to_fd(&empty, fd) && sb_flatten(&empty, &arena).count == 0);
+    sb_chunked_appendf(&empty, "%s", "");
+    assert(empty.count == 0);
+
+    sb_free(&expected);
+    sb_free(&written);
+    arena_free(&arena);
+    return 0;
+}
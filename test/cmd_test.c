@@ -0,0 +1,86 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+#define JOB_COUNT 9
+#define MAX_JOBS 3
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+    Cmd cmd = {0};
+    cmd_append(&cmd, "sh", "-c", "exit 0");
+    assert(cmd.count == 3);
+    assert(cmd_run_sync(&cmd));
+
+    int exit_code = 0;
+    cmd.count = 0;
+    cmd_append(&cmd, "sh", "-c", "exit 7");
+    Proc proc = cmd_run_async(&cmd);
+    assert(proc != INVALID_PROC);
+    assert(!proc_wait(proc, &exit_code) && exit_code == 7);
+
+    cmd.count = 0;
+    cmd_append(&cmd, "this-command-does-not-exist");
+    assert(cmd_run_async(&cmd) == INVALID_PROC);
+    printf("cmd ok\n");
+
+    // 9 jobs of 100ms over 3 slots take at least 3 rounds. No upper bound, a
+    // loaded machine can be arbitrarily slow; the slot limit is checked directly
+    Procs procs;
+    procs_init(&procs, MAX_JOBS);
+    char script[64];
+    double start = now_seconds();
+    for(int i = 0; i < JOB_COUNT; ++i) {
+        snprintf(script, sizeof(script), "sleep 0.1; exit %d", i);
+        cmd.count = 0;
+        cmd_append(&cmd, "sh", "-c", script);
+        assert(procs_run(&procs, &cmd));
+        assert(procs.running.count <= MAX_JOBS);
+    }
+    assert(!procs_wait_all(&procs));
+    double elapsed = now_seconds() - start;
+    printf("%d jobs in %.3fs\n", JOB_COUNT, elapsed);
+    assert(elapsed >= 0.3);
+
+    bool seen[JOB_COUNT] = {0};
+    assert(procs.results.count == JOB_COUNT);
+    for(size_t i = 0; i < procs.results.count; ++i) {
+        Proc_Result* r = &procs.results.data[i];
+        assert(r->index < JOB_COUNT && !seen[r->index]);
+        seen[r->index] = true;
+        assert(r->exit_code == (int)r->index && r->ok == (r->index == 0));
+        assert(r->wall_seconds >= 0.09);
+    }
+    procs_free(&procs);
+    printf("procs ok\n");
+
+    // Signals and spawn failures are results too
+    procs_init(&procs, 0);
+    cmd.count = 0;
+    cmd_append(&cmd, "sh", "-c", "kill -9 $$");
+    assert(procs_run(&procs, &cmd));
+    cmd.count = 0;
+    cmd_append(&cmd, "this-command-does-not-exist");
+    assert(!procs_run(&procs, &cmd));
+    assert(!procs_wait_all(&procs));
+    assert(procs.results.count == 2);
+    for(size_t i = 0; i < procs.results.count; ++i) {
+        Proc_Result* r = &procs.results.data[i];
+        assert(r->exit_code == (r->index == 0 ? 128 + 9 : 127));
+    }
+    procs_free(&procs);
+    printf("failures ok\n");
+
+    da_free(&cmd);
+    return 0;
+}
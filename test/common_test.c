@@ -1,8 +1,73 @@
 #define COMMON_IMPLEMENTATION
 #include "../common.h"
 
+#include <assert.h>
+#include <stdio.h>
+
+typedef da(int) Ints;
+typedef da_inline(int, 4) Small_Ints;
+
+static void test_da(void)
+{
+    Ints xs = {0};
+    int items[100];
+    for(int i = 0; i < 100; ++i) items[i] = i;
+
+    // A bulk append far larger than twice the capacity still lands in one allocation
+    da_append_many(&xs, items, 100);
+    assert(xs.count == 100);
+    assert(xs.capacity >= 100);
+    for(int i = 0; i < 100; ++i) assert(xs.data[i] == i);
+
+    int head[] = { -3, -2, -1 };
+    da_insert_many(&xs, 0, head, 3);
+    assert(xs.count == 103);
+    assert(xs.data[0] == -3 && xs.data[2] == -1 && xs.data[3] == 0 && xs.data[102] == 99);
+
+    da_remove_swap(&xs, 0);
+    assert(xs.count == 102);
+    assert(xs.data[0] == 99);
+
+    da_resize(&xs, 10);
+    assert(xs.count == 10);
+    da_reserve(&xs, 1000);
+    assert(xs.capacity >= 1000);
+    assert(xs.data[1] == -2);
+    da_free(&xs);
+}
+
+static void test_da_inline(void)
+{
+    Small_Ints xs = {0};
+    da_inline_append(&xs, 1);
+    da_inline_append(&xs, 2);
+    assert(xs.data == xs.inline_data);
+    assert(xs.capacity == 4);
+
+    int more[] = { 3, 4 };
+    da_inline_append_many(&xs, more, 2);
+    assert(xs.data == xs.inline_data);
+
+    // Spills to the heap past the inline capacity
+    da_inline_append(&xs, 5);
+    assert(xs.data != xs.inline_data);
+    assert(xs.count == 5);
+    for(int i = 0; i < 5; ++i) assert(xs.data[i] == i + 1);
+
+    int front[] = { 0 };
+    da_inline_insert_many(&xs, 0, front, 1);
+    for(int i = 0; i < 6; ++i) assert(xs.data[i] == i);
+
+    da_remove_swap(&xs, 1);
+    assert(xs.count == 5 && xs.data[1] == 5);
+    da_inline_free(&xs);
+    assert(xs.data == NULL);
+}
+
 int main(void)
 {
+    test_da();
+    test_da_inline();
+    printf("OK\n");
     return 0;
 }
-
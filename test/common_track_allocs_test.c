@@ -0,0 +1,83 @@
+#define COMMON_TRACK_ALLOCS
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define THREAD_COUNT 4
+#define ALLOCS_PER_THREAD 10000
+
+typedef da(int) Ints;
+
+static Common_Alloc_Site sites[64];
+
+static const Common_Alloc_Site* find_site(size_t count, int line)
+{
+    for(size_t i = 0; i < count; ++i) {
+        if(sites[i].line == line) return &sites[i];
+    }
+    return NULL;
+}
+
+static void* alloc_and_free(void* arg)
+{
+    (void)arg;
+    for(int i = 0; i < ALLOCS_PER_THREAD; ++i) {
+        void* p = COMMON_MALLOC(24);
+        COMMON_FREE(p);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    // Growth one item at a time, the hot pattern this is meant to find
+    Ints xs = {0};
+    int append_line = __LINE__ + 1;
+    for(int i = 0; i < 100000; ++i) da_append(&xs, i);
+    for(int i = 0; i < 100000; ++i) assert(xs.data[i] == i);
+
+    int malloc_line = __LINE__ + 1;
+    char* kept = COMMON_MALLOC(1000);
+    kept[999] = 1;
+
+    size_t count = common_alloc_sites(sites, 64);
+    const Common_Alloc_Site* append = find_site(count, append_line);
+    assert(append != NULL);
+    assert(append->count > 10 && append->count < 20); // doubling from DA_INIT_CAPACITY
+    assert(append->live_bytes == xs.capacity * sizeof(int));
+    assert(append->realloc_copies <= append->count);
+    const Common_Alloc_Site* single = find_site(count, malloc_line);
+    assert(single != NULL && single->count == 1 && single->bytes == 1000 && single->live_bytes == 1000);
+
+    da_free(&xs);
+    COMMON_FREE(kept);
+    count = common_alloc_sites(sites, 64);
+    assert(find_site(count, append_line)->live_bytes == 0);
+    assert(find_site(count, malloc_line)->frees == 1);
+
+    // Same site from several threads, the counters must add up
+    pthread_t threads[THREAD_COUNT];
+    for(int i = 0; i < THREAD_COUNT; ++i) pthread_create(&threads[i], NULL, alloc_and_free, NULL);
+    for(int i = 0; i < THREAD_COUNT; ++i) pthread_join(threads[i], NULL);
+    count = common_alloc_sites(sites, 64);
+    size_t threaded = 0;
+    for(size_t i = 0; i < count; ++i) {
+        if(sites[i].count == THREAD_COUNT * ALLOCS_PER_THREAD) {
+            assert(sites[i].bytes == THREAD_COUNT * ALLOCS_PER_THREAD * 24);
+            assert(sites[i].frees == THREAD_COUNT * ALLOCS_PER_THREAD);
+            assert(sites[i].live_bytes == 0);
+            threaded += 1;
+        }
+    }
+    assert(threaded == 1);
+
+    // Heaviest copiers first
+    for(size_t i = 1; i < count; ++i) assert(sites[i - 1].realloc_copy_bytes >= sites[i].realloc_copy_bytes);
+
+    common_alloc_report(8);
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,94 @@
+#define COMMON_SIMD
+#define COMMON_IMPLEMENTATION
+#define ARENA_IMPLEMENTATION
+#define CSV_THREADS
+#define CSV_IMPLEMENTATION
+#include "../csv.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define INPUT_SIZE (128*1024*1024)
+#define REPEAT 3
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, double seconds, size_t bytes, size_t fields)
+{
+    double per_run = seconds / REPEAT;
+    printf("%-28s %8.1f ms %8.1f MB/s %8.1f Mfields/s\n", name, per_run * 1e3,
+            (double)bytes / per_run * 1e-6, (double)fields / per_run * 1e-6);
+}
+
+static void count_fields(void* user, size_t chunk, const Csv_Row* row)
+{
+    size_t* fields = user;
+    fields[chunk] += row->count;
+}
+
+int main(void)
+{
+    // Log-like rows: numbers, short words and the odd quoted field
+    String_Builder csv = {0};
+    da_reserve(&csv, INPUT_SIZE + 256);
+    char line[256];
+    srand(1);
+    while(csv.count < INPUT_SIZE) {
+        int n = snprintf(line, sizeof(line), "%d,%d.%02d,user%d,%s,%d\n",
+                rand(), rand() % 1000, rand() % 100, rand() % 5000,
+                rand() % 10 == 0 ? "\"quoted, with comma\"" : "GET", rand() % 600);
+        da_append_many(&csv, line, (size_t)n);
+    }
+    String_View input = sv_from_parts(csv.data, csv.count);
+
+    // Baseline: what the hand-written loops do, no quote handling
+    size_t expected_fields = 0;
+    double start = now_seconds();
+    for(int r = 0; r < REPEAT; ++r) {
+        expected_fields = 0;
+        String_View rest = input;
+        while(rest.count > 0) {
+            String_View record = sv_chop_by_delim(&rest, '\n');
+            while(record.count > 0) {
+                sv_chop_by_delim(&record, ',');
+                expected_fields += 1;
+            }
+        }
+    }
+    report("sv_chop_by_delim", now_seconds() - start, input.count, expected_fields);
+
+    size_t fields = 0;
+    start = now_seconds();
+    for(int r = 0; r < REPEAT; ++r) {
+        Csv_Reader reader;
+        Csv_Row row = {0};
+        fields = 0;
+        csv_reader_init(&reader, input, CSV_DIALECT_CSV);
+        while(csv_next_row(&reader, &row)) fields += row.count;
+        csv_reader_free(&reader);
+        da_free(&row);
+    }
+    report("csv_next_row", now_seconds() - start, input.count, fields);
+
+    size_t per_chunk[CSV_MAX_THREADS];
+    start = now_seconds();
+    for(int r = 0; r < REPEAT; ++r) {
+        memset(per_chunk, 0, sizeof(per_chunk));
+        csv_parse_parallel(input, CSV_DIALECT_CSV, count_fields, per_chunk);
+    }
+    double elapsed = now_seconds() - start;
+    size_t parallel_fields = 0;
+    for(size_t k = 0; k < CSV_MAX_THREADS; ++k) parallel_fields += per_chunk[k];
+    report("csv_parse_parallel", elapsed, input.count, parallel_fields);
+    assert(parallel_fields == fields);
+
+    da_free(&csv);
+    return 0;
+}
@@ -0,0 +1,198 @@
+// csv_scalar_test builds without it to cover the scalar scanner
+#ifndef CSV_TEST_NO_SIMD
+    #define COMMON_SIMD
+#endif
+#define COMMON_IMPLEMENTATION
+#define ARENA_IMPLEMENTATION
+// Small windows so rows and quoted fields cross refills and chunks
+#define CSV_WINDOW_SIZE 256
+#define CSV_THREADS
+#define CSV_IMPLEMENTATION
+#include "../csv.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ROW_COUNT 5000
+#define MAX_FIELDS 8
+#define MAX_FIELD_SIZE 24
+
+typedef struct {
+    size_t field_count;
+    char fields[MAX_FIELDS][MAX_FIELD_SIZE];
+    size_t sizes[MAX_FIELDS];
+} Test_Row;
+
+static Test_Row rows[ROW_COUNT];
+
+static char random_char(void)
+{
+    static const char alphabet[] = "abcXYZ 012,\"\n\r\t;";
+    return alphabet[rand() % (sizeof(alphabet) - 1)];
+}
+
+// Random rows and their CSV encoding, quoting only the fields that need it
+static void generate(String_Builder* csv)
+{
+    for(size_t r = 0; r < ROW_COUNT; ++r) {
+        Test_Row* row = &rows[r];
+        row->field_count = 1 + (size_t)(rand() % MAX_FIELDS);
+        for(size_t f = 0; f < row->field_count; ++f) {
+            row->sizes[f] = (size_t)(rand() % MAX_FIELD_SIZE);
+            for(size_t i = 0; i < row->sizes[f]; ++i) row->fields[f][i] = random_char();
+
+            bool quoted = rand() % 8 == 0;
+            for(size_t i = 0; i < row->sizes[f]; ++i) {
+                char c = row->fields[f][i];
+                if(c == ',' || c == '"' || c == '\n' || c == '\r') quoted = true;
+            }
+            if(f > 0) da_append(csv, ',');
+            if(quoted) da_append(csv, '"');
+            for(size_t i = 0; i < row->sizes[f]; ++i) {
+                if(row->fields[f][i] == '"') da_append(csv, '"');
+                da_append(csv, row->fields[f][i]);
+            }
+            if(quoted) da_append(csv, '"');
+        }
+        if(rand() % 2) da_append(csv, '\r');
+        da_append(csv, '\n');
+    }
+}
+
+static void check_row(Arena* arena, const Csv_Row* row, size_t r)
+{
+    assert(row->count == rows[r].field_count);
+    for(size_t f = 0; f < row->count; ++f) {
+        String_View value = csv_unescape(arena, row->data[f], CSV_DIALECT_CSV);
+        assert(sv_eq_ci(value, sv_from_parts(rows[r].fields[f], rows[r].sizes[f])));
+        assert(memcmp(value.data, rows[r].fields[f], value.count) == 0);
+    }
+}
+
+typedef struct {
+    size_t rows_per_chunk[CSV_MAX_THREADS];
+    uint64_t hash_per_chunk[CSV_MAX_THREADS];
+} Totals;
+
+static void count_row(void* user, size_t chunk, const Csv_Row* row)
+{
+    Totals* totals = user;
+    totals->rows_per_chunk[chunk] += 1;
+    for(size_t f = 0; f < row->count; ++f) totals->hash_per_chunk[chunk] += sv_hash64(row->data[f], f);
+}
+
+int main(void)
+{
+    printf("backend: %s\n", COMMON_SIMD_AVX2 ? "avx2" : COMMON_SIMD_SSE2 ? "sse2" : "scalar");
+    // Fields that need no copy point into the input
+    {
+        Arena arena = {0};
+        String_View input = sv_from_cstr("a,\"b,c\",\"d\"\"e\"\r\n,\n\"multi\nline\"\nlast");
+        Csv_Reader reader;
+        Csv_Row row = {0};
+        csv_reader_init(&reader, input, CSV_DIALECT_CSV);
+
+        assert(csv_next_row(&reader, &row) && row.count == 3);
+        assert(sv_eq(sv_from_cstr("a"), row.data[0]) && row.data[0].data == input.data);
+        String_View bc = csv_unescape(&arena, row.data[1], CSV_DIALECT_CSV);
+        assert(bc.count == 3 && memcmp(bc.data, "b,c", 3) == 0 && bc.data == input.data + 3);
+        String_View de = csv_unescape(&arena, row.data[2], CSV_DIALECT_CSV);
+        assert(de.count == 3 && memcmp(de.data, "d\"e", 3) == 0);
+
+        assert(csv_next_row(&reader, &row) && row.count == 2 && row.data[0].count == 0 && row.data[1].count == 0);
+        assert(csv_next_row(&reader, &row) && row.count == 1);
+        String_View multi = csv_unescape(&arena, row.data[0], CSV_DIALECT_CSV);
+        assert(multi.count == 10 && memcmp(multi.data, "multi\nline", 10) == 0);
+        assert(csv_next_row(&reader, &row) && row.count == 1 && row.data[0].count == 4);
+        assert(!csv_next_row(&reader, &row));
+
+        // TSV has no quoting
+        csv_reader_free(&reader);
+        csv_reader_init(&reader, sv_from_cstr("\"a\tb\"\tc\n"), CSV_DIALECT_TSV);
+        assert(csv_next_row(&reader, &row) && row.count == 3);
+        assert(!csv_next_row(&reader, &row));
+        csv_reader_free(&reader);
+        da_free(&row);
+        arena_free(&arena);
+    }
+    printf("basics ok\n");
+
+    srand(42);
+    String_Builder csv = {0};
+    generate(&csv);
+    String_View input = sv_from_parts(csv.data, csv.count);
+
+    // Sequential
+    {
+        Arena arena = {0};
+        Csv_Reader reader;
+        Csv_Row row = {0};
+        csv_reader_init(&reader, input, CSV_DIALECT_CSV);
+        size_t r = 0;
+        while(csv_next_row(&reader, &row)) check_row(&arena, &row, r++);
+        assert(r == ROW_COUNT);
+        csv_reader_free(&reader);
+        da_free(&row);
+        arena_free(&arena);
+    }
+    printf("sequential ok\n");
+
+    // Chunks of whole rows, read in order they give back the same rows
+    for(size_t chunk_count = 1; chunk_count <= 16; ++chunk_count) {
+        Arena arena = {0};
+        Csv_Reader readers[16];
+        Csv_Row row = {0};
+        size_t count = csv_split(input, CSV_DIALECT_CSV, chunk_count, readers);
+        assert(count == chunk_count);
+        size_t r = 0;
+        for(size_t k = 0; k < count; ++k) {
+            while(csv_next_row(&readers[k], &row)) check_row(&arena, &row, r++);
+            csv_reader_free(&readers[k]);
+        }
+        assert(r == ROW_COUNT);
+        da_free(&row);
+        arena_free(&arena);
+    }
+    printf("split ok\n");
+
+    // Parallel over a memory map
+    {
+        char path[] = "/tmp/csv_test_XXXXXX";
+        int fd = mkstemp(path);
+        assert(fd >= 0);
+        assert(write(fd, csv.data, csv.count) == (ssize_t)csv.count);
+        void* map = mmap(NULL, csv.count, PROT_READ, MAP_PRIVATE, fd, 0);
+        assert(map != MAP_FAILED);
+
+        Totals totals = {0};
+        csv_parse_parallel(sv_from_parts(map, csv.count), CSV_DIALECT_CSV, count_row, &totals);
+        size_t row_count = 0;
+        uint64_t hash = 0, expected_hash = 0;
+        for(size_t k = 0; k < CSV_MAX_THREADS; ++k) {
+            row_count += totals.rows_per_chunk[k];
+            hash += totals.hash_per_chunk[k];
+        }
+        Csv_Reader reader;
+        Csv_Row row = {0};
+        csv_reader_init(&reader, input, CSV_DIALECT_CSV);
+        while(csv_next_row(&reader, &row)) {
+            for(size_t f = 0; f < row.count; ++f) expected_hash += sv_hash64(row.data[f], f);
+        }
+        assert(row_count == ROW_COUNT);
+        assert(hash == expected_hash);
+        csv_reader_free(&reader);
+        da_free(&row);
+
+        munmap(map, csv.count);
+        close(fd);
+        unlink(path);
+    }
+    printf("parallel ok\n");
+
+    da_free(&csv);
+    return 0;
+}
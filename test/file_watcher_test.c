@@ -0,0 +1,90 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+#define ROOT "/tmp/file_watcher_test"
+#define DEBOUNCE_MS 50
+
+static void write_file(const char* path, const char* content)
+{
+    assert(save_file_data(path, content, strlen(content)));
+}
+
+static bool has_changed(const File_Watcher* w, const char* path)
+{
+    for(size_t i = 0; i < w->changed.count; ++i) {
+        if(sv_eq(w->changed.data[i], sv_from_cstr(path))) return true;
+    }
+    return false;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+    Cmd cmd = {0};
+    cmd_append(&cmd, "rm", "-rf", ROOT);
+    assert(cmd_run_sync(&cmd));
+    assert(mkdir(ROOT, 0755) == 0);
+    assert(mkdir(ROOT "/data", 0755) == 0);
+    write_file(ROOT "/data/a.txt", "a");
+
+    File_Watcher w;
+    assert(watcher_init(&w, DEBOUNCE_MS));
+    assert(watcher_add_tree(&w, ROOT "/"));
+
+    double start = now_seconds();
+    assert(!watcher_wait(&w, 100));
+    assert(now_seconds() - start >= 0.09);
+    printf("timeout ok\n");
+
+    // A burst on one file is one entry
+    for(int i = 0; i < 100; ++i) write_file(ROOT "/data/a.txt", "burst");
+    write_file(ROOT "/b.txt", "b");
+    assert(watcher_wait(&w, 1000));
+    assert(w.changed.count == 2);
+    assert(has_changed(&w, ROOT "/data/a.txt"));
+    assert(has_changed(&w, ROOT "/b.txt"));
+    printf("burst ok\n");
+
+    // A new directory is watched, along with what got into it before that
+    assert(mkdir(ROOT "/data/new", 0755) == 0);
+    write_file(ROOT "/data/new/c.txt", "c");
+    assert(watcher_wait(&w, 1000));
+    assert(has_changed(&w, ROOT "/data/new"));
+    assert(has_changed(&w, ROOT "/data/new/c.txt"));
+    write_file(ROOT "/data/new/c.txt", "c2");
+    assert(watcher_wait(&w, 1000));
+    assert(w.changed.count == 1 && has_changed(&w, ROOT "/data/new/c.txt"));
+    printf("new directory ok\n");
+
+    // Atomic replace, delete and a moved directory
+    write_file(ROOT "/data/a.tmp", "replaced");
+    assert(rename(ROOT "/data/a.tmp", ROOT "/data/a.txt") == 0);
+    assert(remove(ROOT "/b.txt") == 0);
+    assert(watcher_wait(&w, 1000));
+    assert(has_changed(&w, ROOT "/data/a.txt"));
+    assert(has_changed(&w, ROOT "/b.txt"));
+
+    assert(rename(ROOT "/data/new", ROOT "/moved") == 0);
+    assert(watcher_wait(&w, 1000));
+    assert(has_changed(&w, ROOT "/data/new"));
+    assert(has_changed(&w, ROOT "/moved"));
+    write_file(ROOT "/moved/c.txt", "c3");
+    assert(watcher_wait(&w, 1000));
+    assert(w.changed.count == 1 && has_changed(&w, ROOT "/moved/c.txt"));
+    printf("replace, delete and move ok\n");
+
+    watcher_free(&w);
+    assert(cmd_run_sync(&cmd));
+    da_free(&cmd);
+    return 0;
+}
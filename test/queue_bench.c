@@ -0,0 +1,137 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#define ITEMS_PER_PRODUCER (1000*1000)
+#define QUEUE_CAPACITY 1024
+#define BATCH_SIZE 32
+#define MAX_THREADS 8
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct {
+    Spsc_Queue* spsc;
+    Mpmc_Queue* mpmc;
+    size_t batch;
+    size_t received;
+    uint64_t latency_sum;
+    uint64_t latency_max;
+} Bench_Thread;
+
+static void* producer(void* arg)
+{
+    Bench_Thread* t = arg;
+    uint64_t items[BATCH_SIZE];
+    for(size_t sent = 0; sent < ITEMS_PER_PRODUCER;) {
+        size_t n = t->batch;
+        if(n > ITEMS_PER_PRODUCER - sent) n = ITEMS_PER_PRODUCER - sent;
+        uint64_t ts = now_ns();
+        for(size_t i = 0; i < n; ++i) items[i] = ts;
+
+        size_t pushed = 0;
+        while(pushed < n) {
+            size_t k = t->spsc ? spsc_push_many(t->spsc, items + pushed, n - pushed)
+                               : mpmc_push_many(t->mpmc, items + pushed, n - pushed);
+            if(k == 0) sched_yield();
+            pushed += k;
+        }
+        sent += n;
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    Bench_Thread* t = arg;
+    uint64_t items[BATCH_SIZE];
+    for(;;) {
+        size_t n = t->spsc ? spsc_pop_many_wait(t->spsc, items, t->batch)
+                           : mpmc_pop_many_wait(t->mpmc, items, t->batch);
+        uint64_t now = now_ns();
+        size_t stops = 0;
+        for(size_t i = 0; i < n; ++i) {
+            // A zero timestamp is the stop sentinel, one is pushed per consumer
+            if(items[i] == 0) {
+                stops += 1;
+                continue;
+            }
+            uint64_t latency = now - items[i];
+            t->latency_sum += latency;
+            if(latency > t->latency_max) t->latency_max = latency;
+            t->received += 1;
+        }
+        if(stops > 0) {
+            // A batch may have grabbed the sentinels of other consumers, hand them back
+            uint64_t stop = 0;
+            for(size_t i = 1; i < stops; ++i) {
+                while(!(t->spsc ? spsc_push(t->spsc, &stop) : mpmc_push(t->mpmc, &stop))) sched_yield();
+            }
+            return NULL;
+        }
+    }
+}
+
+static void run(const char* name, Spsc_Queue* spsc, Mpmc_Queue* mpmc, size_t threads, size_t batch)
+{
+    pthread_t producers[MAX_THREADS], consumers[MAX_THREADS];
+    Bench_Thread p[MAX_THREADS] = {0}, c[MAX_THREADS] = {0};
+
+    uint64_t start = now_ns();
+    for(size_t i = 0; i < threads; ++i) {
+        c[i] = (Bench_Thread){ .spsc = spsc, .mpmc = mpmc, .batch = batch };
+        p[i] = (Bench_Thread){ .spsc = spsc, .mpmc = mpmc, .batch = batch };
+        pthread_create(&consumers[i], NULL, consumer, &c[i]);
+        pthread_create(&producers[i], NULL, producer, &p[i]);
+    }
+    for(size_t i = 0; i < threads; ++i) pthread_join(producers[i], NULL);
+    uint64_t stop = 0;
+    for(size_t i = 0; i < threads; ++i) {
+        while(!(spsc ? spsc_push(spsc, &stop) : mpmc_push(mpmc, &stop))) sched_yield();
+    }
+    for(size_t i = 0; i < threads; ++i) pthread_join(consumers[i], NULL);
+    double seconds = (double)(now_ns() - start) * 1e-9;
+
+    size_t received = 0;
+    uint64_t latency_sum = 0, latency_max = 0;
+    for(size_t i = 0; i < threads; ++i) {
+        received += c[i].received;
+        latency_sum += c[i].latency_sum;
+        if(c[i].latency_max > latency_max) latency_max = c[i].latency_max;
+    }
+    assert(received == threads * ITEMS_PER_PRODUCER);
+
+    printf("%-6s threads=%zux%zu batch=%-3zu %8.2f Mops/s  latency avg=%8.0fns max=%10lluns\n",
+            name, threads, threads, batch, (double)received / seconds * 1e-6,
+            (double)latency_sum / (double)received, (unsigned long long)latency_max);
+}
+
+int main(void)
+{
+    size_t batches[] = { 1, BATCH_SIZE };
+
+    for(size_t b = 0; b < 2; ++b) {
+        Spsc_Queue spsc;
+        assert(spsc_init(&spsc, sizeof(uint64_t), QUEUE_CAPACITY));
+        run("spsc", &spsc, NULL, 1, batches[b]);
+        spsc_deinit(&spsc);
+    }
+
+    for(size_t b = 0; b < 2; ++b) {
+        for(size_t threads = 1; threads <= MAX_THREADS; threads *= 2) {
+            Mpmc_Queue mpmc;
+            assert(mpmc_init(&mpmc, sizeof(uint64_t), QUEUE_CAPACITY));
+            run("mpmc", NULL, &mpmc, threads, batches[b]);
+            mpmc_deinit(&mpmc);
+        }
+    }
+    return 0;
+}
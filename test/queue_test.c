@@ -0,0 +1,191 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define ITEMS_PER_PRODUCER 50000
+#define STOP (-1)
+
+static void test_spsc(void)
+{
+    Spsc_Queue q;
+    assert(spsc_init(&q, sizeof(int), 5));
+    assert(q.mask + 1 == 8);
+
+    // Full and empty
+    int x = 0;
+    assert(!spsc_pop(&q, &x));
+    for(int i = 0; i < 8; ++i) assert(spsc_push(&q, &i));
+    x = 8;
+    assert(!spsc_push(&q, &x));
+    for(int i = 0; i < 8; ++i) assert(spsc_pop(&q, &x) && x == i);
+    assert(!spsc_pop(&q, &x));
+
+    // The indices keep counting past the capacity
+    for(int round = 0; round < 100; ++round) {
+        for(int i = 0; i < 5; ++i) {
+            int item = round * 5 + i;
+            assert(spsc_push(&q, &item));
+        }
+        for(int i = 0; i < 5; ++i) assert(spsc_pop(&q, &x) && x == round * 5 + i);
+    }
+    assert(q.head > 8 * (q.mask + 1));
+
+    // Batches that cross the end of the ring and only partly fit
+    int items[10], out[10];
+    for(int i = 0; i < 10; ++i) items[i] = 100 + i;
+    for(int i = 0; i < 6; ++i) assert(spsc_push(&q, &i) && spsc_pop(&q, &x));
+    assert(spsc_push_many(&q, items, 10) == 8);
+    assert(spsc_push_many(&q, items, 10) == 0);
+    assert(spsc_pop_many(&q, out, 3) == 3);
+    assert(out[0] == 100 && out[2] == 102);
+    assert(spsc_pop_many(&q, out, 10) == 5);
+    for(int i = 0; i < 5; ++i) assert(out[i] == 103 + i);
+    assert(spsc_pop_many(&q, out, 10) == 0);
+
+    spsc_deinit(&q);
+    printf("spsc ok\n");
+}
+
+static void test_mpmc(void)
+{
+    Mpmc_Queue q;
+    assert(mpmc_init(&q, sizeof(int), 5));
+
+    int x = 0;
+    assert(!mpmc_pop(&q, &x));
+    for(int i = 0; i < 8; ++i) assert(mpmc_push(&q, &i));
+    x = 8;
+    assert(!mpmc_push(&q, &x));
+    for(int i = 0; i < 8; ++i) assert(mpmc_pop(&q, &x) && x == i);
+    assert(!mpmc_pop(&q, &x));
+
+    for(int round = 0; round < 100; ++round) {
+        for(int i = 0; i < 5; ++i) {
+            int item = round * 5 + i;
+            assert(mpmc_push(&q, &item));
+        }
+        for(int i = 0; i < 5; ++i) assert(mpmc_pop(&q, &x) && x == round * 5 + i);
+    }
+
+    int items[10], out[10];
+    for(int i = 0; i < 10; ++i) items[i] = 100 + i;
+    for(int i = 0; i < 6; ++i) assert(mpmc_push(&q, &i) && mpmc_pop(&q, &x));
+    assert(mpmc_push_many(&q, items, 10) == 8);
+    assert(mpmc_push_many(&q, items, 10) == 0);
+    assert(mpmc_pop_many(&q, out, 3) == 3);
+    assert(out[0] == 100 && out[2] == 102);
+    assert(mpmc_pop_many(&q, out, 10) == 5);
+    for(int i = 0; i < 5; ++i) assert(out[i] == 103 + i);
+    assert(mpmc_pop_many(&q, out, 10) == 0);
+
+    mpmc_deinit(&q);
+    printf("mpmc ok\n");
+}
+
+typedef struct {
+    Mpmc_Queue* q;
+    int producer;
+    unsigned char* seen;
+} Worker;
+
+static void* producer(void* arg)
+{
+    Worker* w = arg;
+    for(int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+        int item = w->producer * ITEMS_PER_PRODUCER + i;
+        while(!mpmc_push(w->q, &item)) sched_yield();
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    Worker* w = arg;
+    for(;;) {
+        int item;
+        mpmc_pop_wait(w->q, &item);
+        if(item == STOP) return NULL;
+        __atomic_add_fetch(&w->seen[item], 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Every item arrives exactly once with several threads on both ends
+static void test_mpmc_threads(void)
+{
+    Mpmc_Queue q;
+    assert(mpmc_init(&q, sizeof(int), 64));
+    unsigned char* seen = calloc(PRODUCERS * ITEMS_PER_PRODUCER, 1);
+
+    pthread_t producers[PRODUCERS], consumers[CONSUMERS];
+    Worker workers[PRODUCERS];
+    Worker consumer_worker = { .q = &q, .seen = seen };
+    for(int c = 0; c < CONSUMERS; ++c) assert(pthread_create(&consumers[c], NULL, consumer, &consumer_worker) == 0);
+    for(int p = 0; p < PRODUCERS; ++p) {
+        workers[p] = (Worker){ .q = &q, .producer = p, .seen = seen };
+        assert(pthread_create(&producers[p], NULL, producer, &workers[p]) == 0);
+    }
+    for(int p = 0; p < PRODUCERS; ++p) pthread_join(producers[p], NULL);
+    int stop = STOP;
+    for(int c = 0; c < CONSUMERS; ++c) while(!mpmc_push(&q, &stop)) sched_yield();
+    for(int c = 0; c < CONSUMERS; ++c) pthread_join(consumers[c], NULL);
+
+    for(int i = 0; i < PRODUCERS * ITEMS_PER_PRODUCER; ++i) assert(seen[i] == 1);
+    free(seen);
+    mpmc_deinit(&q);
+    printf("mpmc threads ok\n");
+}
+
+static void* spsc_waiter(void* arg)
+{
+    int x = 0;
+    spsc_pop_wait(arg, &x);
+    assert(x == 42);
+    return NULL;
+}
+
+static void* mpmc_waiter(void* arg)
+{
+    int items[4];
+    size_t n = mpmc_pop_many_wait(arg, items, 4);
+    assert(n >= 1 && items[0] == 7);
+    return NULL;
+}
+
+// A consumer asleep on an empty queue wakes up when an item arrives
+static void test_pop_wait(void)
+{
+    struct timespec pause = { .tv_sec = 0, .tv_nsec = 50 * 1000000 };
+
+    Spsc_Queue spsc;
+    assert(spsc_init(&spsc, sizeof(int), 4));
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, spsc_waiter, &spsc) == 0);
+    nanosleep(&pause, NULL);
+    int x = 42;
+    assert(spsc_push(&spsc, &x));
+    pthread_join(thread, NULL);
+    spsc_deinit(&spsc);
+
+    Mpmc_Queue mpmc;
+    assert(mpmc_init(&mpmc, sizeof(int), 4));
+    assert(pthread_create(&thread, NULL, mpmc_waiter, &mpmc) == 0);
+    nanosleep(&pause, NULL);
+    x = 7;
+    assert(mpmc_push(&mpmc, &x));
+    pthread_join(thread, NULL);
+    mpmc_deinit(&mpmc);
+    printf("pop_wait ok\n");
+}
+
+int main(void)
+{
+    test_spsc();
+    test_mpmc();
+    test_mpmc_threads();
+    test_pop_wait();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+// Also built with STREAM_READER_NO_IO_URING to cover the pread worker thread
+#ifdef STREAM_READER_NO_IO_URING
+    #define TEST_FILE_PATH "/tmp/stream_reader_thread_test.txt"
+#else
+    #define TEST_FILE_PATH "/tmp/stream_reader_test.txt"
+#endif
+
+int main(void)
+{
+    // Records longer than the chunk size force the reader to grow its carry prefix
+    const char* text =
+        "alpha\n"
+        "beta\n"
+        "\n"
+        "a record that is definitely longer than sixteen bytes\n"
+        "gamma,delta\n"
+        "last line without newline";
+    const char* expected[] = {
+        "alpha",
+        "beta",
+        "",
+        "a record that is definitely longer than sixteen bytes",
+        "gamma,delta",
+        "last line without newline",
+    };
+    size_t expected_count = sizeof(expected)/sizeof(expected[0]);
+    assert(save_file_data(TEST_FILE_PATH, text, strlen(text)));
+
+    Stream_Reader sr;
+    assert(sr_open(&sr, TEST_FILE_PATH, 16));
+    String_View line;
+    size_t i = 0;
+    while(sr_next_line(&sr, &line)) {
+        assert(i < expected_count);
+        assert(line.count == strlen(expected[i]));
+        assert(memcmp(line.data, expected[i], line.count) == 0);
+        ++i;
+    }
+    assert(i == expected_count);
+    sr_close(&sr);
+
+    // Same file split by a different delimiter, the view must match `sv_chop_by_delim`
+    String_Builder sb = {0};
+    assert(load_file_data(TEST_FILE_PATH, &sb));
+    String_View rest = sv_from_parts(sb.data, sb.count);
+    assert(sr_open(&sr, TEST_FILE_PATH, 7));
+    String_View record;
+    while(sr_next_record(&sr, ',', &record)) {
+        String_View reference = sv_chop_by_delim(&rest, ',');
+        assert(record.count == reference.count);
+        assert(memcmp(record.data, reference.data, record.count) == 0);
+    }
+    assert(rest.count == 0);
+    sr_close(&sr);
+    sb_free(&sb);
+
+    // Closing a reader that was never opened, or twice, leaves fd 0 alone
+    int null_fd = open("/dev/null", O_RDONLY);
+    assert(null_fd >= 0 && dup2(null_fd, 0) == 0);
+    close(null_fd);
+    Stream_Reader zeroed = {0};
+    sr_close(&zeroed);
+    sr_close(&sr);
+    assert(!sr_open(&zeroed, "/tmp/stream_reader_missing.txt", 0));
+    sr_close(&zeroed);
+    assert(fcntl(0, F_GETFD) != -1);
+
+    remove(TEST_FILE_PATH);
+    printf("stream reader ok\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+#define COMMON_SIMD
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEXT_SIZE 4096
+#define TEST_ITERATIONS 20000
+
+static char lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? (char)(c + 32) : c;
+}
+
+static bool reference_eq_ci(const char* a, const char* b, size_t n)
+{
+    for(size_t i = 0; i < n; ++i) {
+        if(lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+static int reference_find_ci(String_View strv, String_View sth, size_t index)
+{
+    size_t found_count = 0;
+    for(size_t i = 0; sth.count > 0 && i + sth.count <= strv.count; ++i) {
+        if(reference_eq_ci(strv.data + i, sth.data, sth.count)) {
+            if(found_count == index) return (int)i;
+            ++found_count;
+        }
+    }
+    return -1;
+}
+
+// Bytes around the case range so every fold boundary gets hit
+static char random_char(void)
+{
+    static const char alphabet[] = "aAbBzZ@[`{-09\x80\xC1\xE1\xFA";
+    return alphabet[rand() % (sizeof(alphabet) - 1)];
+}
+
+int main(void)
+{
+    assert(sv_eq_ci(sv_from_cstr("Content-Length"), sv_from_cstr("content-length")));
+    assert(!sv_eq_ci(sv_from_cstr("Content-Length"), sv_from_cstr("content-lengt")));
+    assert(!sv_eq_ci(sv_from_cstr("@"), sv_from_cstr("`")));
+    assert(!sv_eq_ci(sv_from_cstr("["), sv_from_cstr("{")));
+    assert(sv_has_prefix_ci(sv_from_cstr("ACCEPT-ENCODING: gzip"), sv_from_cstr("accept-encoding:")));
+    assert(!sv_has_prefix_ci(sv_from_cstr("Accept"), sv_from_cstr("accept-encoding")));
+    assert(sv_find_ci(sv_from_cstr("Host: Example.COM"), sv_from_cstr("example.com"), 0) == 6);
+    assert(sv_find_ci(sv_from_cstr("aAaA"), sv_from_cstr("AA"), 2) == 2);
+    assert(sv_find_ci(sv_from_cstr("aAaA"), sv_from_cstr("AA"), 3) == -1);
+
+    static char text[TEXT_SIZE], other[TEXT_SIZE];
+    for(int i = 0; i < TEST_ITERATIONS; ++i) {
+        size_t n = (size_t)(rand() % 80);
+        for(size_t j = 0; j < n; ++j) {
+            text[j] = random_char();
+            other[j] = rand() % 2 ? lower(text[j]) : text[j];
+            if(text[j] >= 'a' && text[j] <= 'z' && rand() % 2) other[j] = (char)(text[j] - 32);
+        }
+        if(n > 0 && rand() % 2) other[rand() % n] = random_char();
+        assert(sv_eq_ci(sv_from_parts(text, n), sv_from_parts(other, n)) == reference_eq_ci(text, other, n));
+    }
+    printf("eq ok\n");
+
+    for(size_t j = 0; j < TEXT_SIZE; ++j) text[j] = random_char();
+    for(int i = 0; i < TEST_ITERATIONS / 10; ++i) {
+        size_t n = 1 + (size_t)(rand() % 4);
+        size_t at = (size_t)rand() % (TEXT_SIZE - n);
+        // Needles taken from the text usually have several matches
+        for(size_t j = 0; j < n; ++j) other[j] = rand() % 2 ? lower(text[at + j]) : text[at + j];
+        String_View haystack = sv_from_parts(text, 100 + (size_t)(rand() % (TEXT_SIZE - 100)));
+        String_View needle = sv_from_parts(other, n);
+        for(size_t index = 0; index < 3; ++index) {
+            assert(sv_find_ci(haystack, needle, index) == reference_find_ci(haystack, needle, index));
+        }
+    }
+    printf("find ok\n");
+
+    return 0;
+}
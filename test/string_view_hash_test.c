@@ -0,0 +1,94 @@
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DATA_SIZE 1024
+#define KEY_COUNT 100000
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+int main(void)
+{
+    // Reference vectors of wyhash final 4, seeded with their index
+    static const struct { const char* message; uint64_t hash; } vectors[] = {
+        { "a", 0xc5bac3db178713c4ull },
+        { "abc", 0xa97f2f7b1d9b3314ull },
+        { "message digest", 0x786d1f1df3801df4ull },
+        { "abcdefghijklmnopqrstuvwxyz", 0xdca5a8138ad37c87ull },
+        { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", 0xb9e734f117cfaf70ull },
+        { "12345678901234567890123456789012345678901234567890123456789012345678901234567890", 0x6cc5eab49a92d617ull },
+    };
+    for(size_t i = 0; i < sizeof(vectors) / sizeof(*vectors); ++i) {
+        assert(sv_hash64(sv_from_cstr(vectors[i].message), i + 1) == vectors[i].hash);
+    }
+    printf("reference vectors ok\n");
+
+    static char data[DATA_SIZE];
+    for(size_t i = 0; i < DATA_SIZE; ++i) data[i] = (char)rand();
+
+    // Streaming matches one-shot for every length and a few ways of splitting it
+    for(size_t n = 0; n <= 300; ++n) {
+        String_View whole = sv_from_parts(data, n);
+        uint64_t expected = sv_hash64(whole, 42);
+        for(size_t split = 0; split <= n; split += n / 7 + 1) {
+            Hash64 h;
+            hash64_init(&h, 42);
+            hash64_update(&h, sv_from_parts(data, split));
+            hash64_update(&h, sv_from_parts(data + split, n - split));
+            assert(hash64_final(&h) == expected);
+        }
+        Hash64 h;
+        hash64_init(&h, 42);
+        for(size_t i = 0; i < n; ++i) hash64_update(&h, sv_from_parts(data + i, 1));
+        assert(hash64_final(&h) == expected);
+        assert(sv_hash64(whole, 43) != expected);
+    }
+    printf("streaming ok\n");
+
+    // A String_Builder hashed as it grows
+    String_Builder sb = {0};
+    Hash64 h;
+    hash64_init(&h, 0);
+    for(int i = 0; i < 100; ++i) {
+        const char* piece = i % 3 ? "Content-Type: text/plain\r\n" : "X: y\r\n";
+        size_t start = sb.count;
+        sb_append_cstr(&sb, piece);
+        hash64_update(&h, sv_from_parts(sb.data + start, sb.count - start));
+    }
+    assert(hash64_final(&h) == sv_hash64(sv_from_parts(sb.data, sb.count), 0));
+    sb_free(&sb);
+    printf("string builder ok\n");
+
+    // No collisions among similar keys, and single bit flips change about half the bits
+    static uint64_t hashes[KEY_COUNT];
+    char key[32];
+    for(int i = 0; i < KEY_COUNT; ++i) {
+        int n = snprintf(key, sizeof(key), "key_%d", i);
+        hashes[i] = sv_hash64(sv_from_parts(key, (size_t)n), 0);
+    }
+    qsort(hashes, KEY_COUNT, sizeof(*hashes), compare_u64);
+    for(int i = 1; i < KEY_COUNT; ++i) assert(hashes[i] != hashes[i - 1]);
+
+    size_t flipped_bits = 0, flips = 0;
+    for(size_t n = 1; n <= 64; ++n) {
+        uint64_t base = sv_hash64(sv_from_parts(data, n), 0);
+        for(size_t bit = 0; bit < n * 8; bit += 3) {
+            data[bit / 8] ^= (char)(1 << (bit % 8));
+            flipped_bits += (size_t)__builtin_popcountll(base ^ sv_hash64(sv_from_parts(data, n), 0));
+            flips += 1;
+            data[bit / 8] ^= (char)(1 << (bit % 8));
+        }
+    }
+    double average = (double)flipped_bits / (double)flips;
+    printf("average flipped bits %.2f\n", average);
+    assert(average > 30.0 && average < 34.0);
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#define CGM_THREADS
+#define CGM_IMPLEMENTATION
+#define TRANSFORM_PARALLEL_THRESHOLD 16
+#define TRANSFORM_IMPLEMENTATION
+#include "../transform.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NODE_COUNT 2000
+#define TEST_EPSILON 1e-3f
+
+static Transform_Id parents[NODE_COUNT * 2];
+
+static float random_float(void)
+{
+    return ((float)rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+}
+
+static Qf random_rotation(void)
+{
+    return qf_from_axis_angle(v3f_normalize(v3f(random_float(), random_float(), random_float())), random_float());
+}
+
+static V3f random_scale(void)
+{
+    return v3f(1.0f + random_float() * 0.1f, 1.0f + random_float() * 0.1f, 1.0f + random_float() * 0.1f);
+}
+
+// The slow way, straight from the definition
+static M4f expected_world(const Transforms* t, Transform_Id id)
+{
+    uint32_t i = t->indices[id];
+    M4f local = m4f_dot(m4f_dot(m4f_scale(t->scales[i]), qf_to_m4f(t->rotations[i])), m4f_translate(t->positions[i]));
+    if(parents[id] == TRANSFORM_NO_PARENT) return local;
+    return m4f_dot(local, expected_world(t, parents[id]));
+}
+
+static void check_worlds(const Transforms* t)
+{
+    for(Transform_Id id = 0; id < t->count; ++id) {
+        M4f expected = expected_world(t, id);
+        const M4f* got = transforms_world(t, id);
+        for(int i = 0; i < 16; ++i) {
+            float magnitude = fabsf(expected.elements[i]) < 1.0f ? 1.0f : fabsf(expected.elements[i]);
+            assert(fabsf(got->elements[i] - expected.elements[i]) <= TEST_EPSILON * magnitude);
+        }
+    }
+}
+
+static Transform_Id add_random(Transforms* t)
+{
+    // Mostly shallow with a few long chains
+    Transform_Id parent = TRANSFORM_NO_PARENT;
+    if(t->count > 0 && rand() % 16 != 0) parent = (Transform_Id)(rand() % t->count);
+    Transform_Id id = transforms_add(t, parent, v3f(random_float(), random_float(), random_float()), random_rotation(), random_scale());
+    parents[id] = parent;
+    return id;
+}
+
+static BOOL is_below(Transform_Id id, Transform_Id ancestor)
+{
+    for(; id != TRANSFORM_NO_PARENT; id = parents[id]) {
+        if(id == ancestor) return TRUE;
+    }
+    return FALSE;
+}
+
+// Changing one node leaves every matrix outside its subtree alone
+static void test_clean_branches(void)
+{
+    Transforms t = {0};
+    Transform_Id roots[2];
+    for(int r = 0; r < 2; ++r) {
+        roots[r] = transforms_add(&t, TRANSFORM_NO_PARENT, v3f(0, 0, 0), qf_identity(), v3f(1, 1, 1));
+        parents[roots[r]] = TRANSFORM_NO_PARENT;
+    }
+    // Three children per node, both trees added interleaved
+    for(size_t i = 0; t.count < 240; ++i) {
+        for(int c = 0; c < 3; ++c) {
+            Transform_Id id = transforms_add(&t, (Transform_Id)i, v3f(random_float(), random_float(), random_float()), random_rotation(), random_scale());
+            parents[id] = (Transform_Id)i;
+        }
+    }
+    transforms_update(&t);
+    check_worlds(&t);
+
+    // Siblings in the same levels, just not below the changed node
+    Transform_Id changed = 0;
+    for(Transform_Id id = 0; id < t.count; ++id) {
+        if(t.depths[t.indices[id]] == 2 && is_below(id, roots[1])) {
+            changed = id;
+            break;
+        }
+    }
+    assert(changed != 0);
+    M4f poison = m4f(1234.0f);
+    for(Transform_Id id = 0; id < t.count; ++id) {
+        if(!is_below(id, changed)) t.worlds[t.indices[id]] = poison;
+    }
+
+    // A flag set behind the setters' back is outside every visited range, a
+    // pass over whole levels would pick it up
+    uint32_t unvisited = t.first_children[t.indices[roots[0]]];
+    assert(t.depths[unvisited] == 1 && !is_below(t.ids[unvisited], changed));
+    t.dirty[unvisited] = 1;
+
+    transforms_set_rotation(&t, changed, random_rotation());
+    transforms_update(&t);
+    assert(t.dirty[unvisited] == 1);
+    t.dirty[unvisited] = 0;
+    size_t recomputed = 0;
+    for(Transform_Id id = 0; id < t.count; ++id) {
+        if(is_below(id, changed)) {
+            recomputed += 1;
+            continue;
+        }
+        assert(memcmp(&t.worlds[t.indices[id]], &poison, sizeof(poison)) == 0);
+    }
+    assert(recomputed > 1 && recomputed < t.count / 4);
+
+    // Put the right matrices back by touching the roots
+    transforms_set_position(&t, roots[0], v3f(1, 0, 0));
+    transforms_set_position(&t, roots[1], v3f(0, 1, 0));
+    transforms_update(&t);
+    check_worlds(&t);
+    transforms_free(&t);
+    printf("clean branches ok\n");
+}
+
+int main(void)
+{
+    srand(69);
+    Transforms t = {0};
+    for(size_t i = 0; i < NODE_COUNT; ++i) add_random(&t);
+    transforms_update(&t);
+    check_worlds(&t);
+    assert(t.level_count > 1);
+
+    // Depth order, every parent is in an earlier level
+    for(size_t i = 0; i < t.count; ++i) {
+        if(t.parents[i] != TRANSFORM_NO_PARENT) assert(t.depths[t.parents[i]] + 1 == t.depths[i]);
+        if(i > 0) assert(t.depths[i - 1] <= t.depths[i]);
+    }
+    // The children of a node are one run right after those of the node before it
+    for(size_t i = 0; i < t.count; ++i) {
+        for(uint32_t c = t.first_children[i]; c < t.first_children[i] + t.child_counts[i]; ++c) assert(t.parents[c] == i);
+        if(i + 1 < t.count && t.depths[i + 1] == t.depths[i]) {
+            assert(t.first_children[i + 1] == t.first_children[i] + t.child_counts[i]);
+        }
+    }
+
+    // Nothing changed, nothing to do
+    transforms_update(&t);
+    assert(t.first_dirty_level == t.level_count);
+
+    for(int n = 0; n < 10; ++n) {
+        Transform_Id id = (Transform_Id)(rand() % t.count);
+        switch(n % 3) {
+            case 0: transforms_set_position(&t, id, v3f(random_float(), random_float(), random_float())); break;
+            case 1: transforms_set_rotation(&t, id, random_rotation()); break;
+            default: transforms_set_scale(&t, id, random_scale()); break;
+        }
+        assert(t.first_dirty_level <= t.depths[t.indices[id]]);
+        transforms_update(&t);
+        check_worlds(&t);
+    }
+
+    // Growing after the first sort keeps ids stable
+    for(size_t i = 0; i < NODE_COUNT; ++i) add_random(&t);
+    transforms_set_position(&t, 0, v3f(5.0f, 0.0f, 0.0f));
+    transforms_update(&t);
+    check_worlds(&t);
+
+    transforms_free(&t);
+    test_clean_branches();
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+// utf8_scalar_test builds without it to cover the scalar validate and decode
+#ifndef UTF8_TEST_NO_SIMD
+    #define COMMON_SIMD
+#endif
+// The long text decodes through the non-temporal stores, the short checks don't
+#define COMMON_UTF8_STREAM_THRESHOLD (64*1024)
+#define COMMON_IMPLEMENTATION
+#include "../common.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ITERATIONS 50000
+#define TEXT_SIZE (1 << 20)
+#define SLICE_CODEPOINTS 400
+
+// Independent reference: decode by the lead byte, then check the codepoint range
+static bool reference_validate(const unsigned char* s, size_t n, size_t* codepoints)
+{
+    size_t count = 0;
+    for(size_t i = 0; i < n; ++count) {
+        unsigned char b = s[i];
+        size_t length;
+        uint32_t cp, min;
+        if(b < 0x80)                { length = 1; cp = b;        min = 0; }
+        else if((b & 0xE0) == 0xC0) { length = 2; cp = b & 0x1F; min = 0x80; }
+        else if((b & 0xF0) == 0xE0) { length = 3; cp = b & 0x0F; min = 0x800; }
+        else if((b & 0xF8) == 0xF0) { length = 4; cp = b & 0x07; min = 0x10000; }
+        else return false;
+        if(i + length > n) return false;
+        for(size_t j = 1; j < length; ++j) {
+            if((s[i + j] & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (s[i + j] & 0x3F);
+        }
+        if(cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+        i += length;
+    }
+    if(codepoints) *codepoints = count;
+    return true;
+}
+
+static size_t encode(uint32_t cp, unsigned char* out)
+{
+    if(cp < 0x80) { out[0] = (unsigned char)cp; return 1; }
+    if(cp < 0x800) {
+        out[0] = (unsigned char)(0xC0 | (cp >> 6));
+        out[1] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if(cp < 0x10000) {
+        out[0] = (unsigned char)(0xE0 | (cp >> 12));
+        out[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (unsigned char)(0xF0 | (cp >> 18));
+    out[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (unsigned char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+static uint32_t random_codepoint(void)
+{
+    switch(rand() % 5) {
+        case 0: case 1: return (uint32_t)(rand() % 0x80);
+        case 2: return 0x80 + (uint32_t)(rand() % (0x800 - 0x80));
+        case 3: {
+            uint32_t cp = 0x800 + (uint32_t)(rand() % (0x10000 - 0x800));
+            return cp >= 0xD800 && cp <= 0xDFFF ? cp - 0x800 : cp;
+        }
+        default: return 0x10000 + (uint32_t)(rand() % (0x110000 - 0x10000));
+    }
+}
+
+static size_t random_text(unsigned char* out, size_t size, uint32_t* codepoints, size_t* codepoint_count)
+{
+    size_t n = 0, count = 0;
+    while(n + 4 <= size) {
+        uint32_t cp = random_codepoint();
+        if(codepoints) codepoints[count] = cp;
+        count += 1;
+        n += encode(cp, out + n);
+    }
+    if(codepoint_count) *codepoint_count = count;
+    return n;
+}
+
+static void check(const unsigned char* s, size_t n)
+{
+    size_t expected_count = 0;
+    bool expected = reference_validate(s, n, &expected_count);
+    String_View sv = sv_from_parts((const char*)s, n);
+    assert(sv_utf8_validate(sv) == expected);
+    if(expected) assert(sv_utf8_count_codepoints(sv) == expected_count);
+
+    // Decoding validates on its own
+    Codepoints codepoints = {0};
+    assert(sv_utf8_to_utf32(sv, &codepoints) == expected);
+    assert(codepoints.count == (expected ? expected_count : 0));
+    da_free(&codepoints);
+}
+
+int main(void)
+{
+    printf("backend: %s\n", COMMON_SIMD_AVX2 ? "avx2" : "scalar");
+    srand(1234);
+
+    // Every 1 and 2 byte sequence, straddling a block boundary in ASCII or multibyte context
+    {
+        unsigned char buffer[96];
+        for(uint32_t pair = 0; pair < 0x10000; ++pair) {
+            for(size_t offset = 30; offset <= 32; ++offset) {
+                memset(buffer, 'a', sizeof(buffer));
+                buffer[offset] = (unsigned char)(pair >> 8);
+                buffer[offset + 1] = (unsigned char)pair;
+                check(buffer, sizeof(buffer));
+                check(buffer, offset + 2);
+                check(buffer, offset + 1);
+                memcpy(buffer + offset - 3, "\xE2\x82\xAC", 3);
+                check(buffer, sizeof(buffer));
+            }
+        }
+    }
+    printf("exhaustive pairs ok\n");
+
+    // Random 3 and 4 byte sequences with a valid looking lead
+    {
+        unsigned char buffer[70];
+        for(int i = 0; i < TEST_ITERATIONS; ++i) {
+            memset(buffer, 'a', sizeof(buffer));
+            size_t offset = 26 + (size_t)(rand() % 12);
+            buffer[offset] = (unsigned char)(0xE0 + rand() % 32);
+            for(size_t j = 1; j < 4; ++j) {
+                buffer[offset + j] = (unsigned char)(rand() % 4 == 0 ? rand() % 256 : 0x80 + rand() % 64);
+            }
+            check(buffer, sizeof(buffer));
+            check(buffer, offset + 1 + (size_t)(rand() % 4));
+        }
+    }
+    printf("random sequences ok\n");
+
+    // Long valid text, then single byte corruptions checked in a window around them
+    static unsigned char text[TEXT_SIZE];
+    static uint32_t expected_codepoints[TEXT_SIZE];
+    size_t codepoint_count = 0;
+    size_t n = random_text(text, TEXT_SIZE, expected_codepoints, &codepoint_count);
+    String_View sv = sv_from_parts((const char*)text, n);
+    assert(sv_utf8_validate(sv));
+    assert(sv_utf8_count_codepoints(sv) == codepoint_count);
+    for(int i = 0; i < 2000; ++i) {
+        size_t at = (size_t)rand() % n;
+        unsigned char saved = text[at];
+        text[at] = (unsigned char)(rand() % 256);
+        // A window around the corruption, the rest of the text is known good
+        size_t start = at > 1000 ? at - 1000 - (size_t)(rand() % 32) : 0;
+        size_t end = at + 1000 < n ? at + 1000 : n;
+        check(text + start, end - start);
+        text[at] = saved;
+    }
+    printf("corruptions ok\n");
+
+    // Decoding, with long ASCII runs for the fast path
+    {
+        Codepoints codepoints = {0};
+        da_append(&codepoints, 42);
+        assert(sv_utf8_to_utf32(sv, &codepoints));
+        assert(codepoints.count == codepoint_count + 1);
+        assert(codepoints.data[0] == 42);
+        assert(memcmp(codepoints.data + 1, expected_codepoints, codepoint_count * sizeof(uint32_t)) == 0);
+
+        String_View it = sv;
+        for(size_t i = 0; i < codepoint_count; ++i) assert(sv_utf8_next(&it) == expected_codepoints[i]);
+        assert(it.count == 0);
+
+        // Every length up to a few blocks from several starts, so each chunk
+        // position, block boundary and tail length decodes against the reference
+        size_t offsets[SLICE_CODEPOINTS + 1] = {0};
+        unsigned char scratch[4];
+        for(size_t i = 0; i < SLICE_CODEPOINTS; ++i) offsets[i + 1] = offsets[i] + encode(expected_codepoints[i], scratch);
+        for(size_t start = 0; start < 16; ++start) {
+            for(size_t count = 0; start + count <= SLICE_CODEPOINTS; ++count) {
+                String_View slice = sv_from_parts((const char*)text + offsets[start], offsets[start + count] - offsets[start]);
+                codepoints.count = 0;
+                assert(sv_utf8_to_utf32(slice, &codepoints));
+                assert(codepoints.count == count);
+                assert(memcmp(codepoints.data, expected_codepoints + start, count * sizeof(uint32_t)) == 0);
+            }
+        }
+
+        String_View mixed = sv_from_cstr("ASCII only, long enough for a whole block... then \xCE\xBB and \xF0\x9F\x98\x80!");
+        codepoints.count = 0;
+        assert(sv_utf8_to_utf32(mixed, &codepoints));
+        assert(codepoints.count == mixed.count - 1 - 3);
+        assert(codepoints.data[codepoints.count - 8] == 0x3BB);
+        assert(codepoints.data[codepoints.count - 2] == 0x1F600);
+
+        String_View invalid = sv_from_cstr("ok \xC0\xAF bad");
+        size_t before = codepoints.count;
+        assert(!sv_utf8_to_utf32(invalid, &codepoints));
+        assert(codepoints.count == before);
+        it = invalid;
+        for(int i = 0; i < 3; ++i) sv_utf8_next(&it);
+        assert(sv_utf8_next(&it) == SV_UTF8_REPLACEMENT);
+        assert(sv_utf8_next(&it) == SV_UTF8_REPLACEMENT);
+        assert(sv_utf8_next(&it) == ' ');
+        da_free(&codepoints);
+    }
+    printf("decoding ok\n");
+
+    return 0;
+}
@@ -0,0 +1,336 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+/**
+ * Transform hierarchy on top of `cgm.h`
+ *
+ * Nodes hold a local position, rotation and scale and get a world matrix
+ * `world = local * parent_world` (row vectors, like the rest of cgm). All the
+ * per-node data lives in flat SoA arrays in breadth-first order, so a parent is
+ * always updated before its children, every depth level is one contiguous range
+ * and the children of consecutive nodes are consecutive in the next level.
+ *
+ * Setters only flag the node as dirty and widen the dirty range of its level.
+ * `transforms_update()` walks the levels top down, visiting the dirty range of
+ * each plus the children of the range visited above, so only the dirty nodes
+ * and their subtrees are touched and clean branches are skipped. The ranges
+ * are split across threads with `cgm_parallel_for()`.
+ * Nodes are addressed by a stable `Transform_Id`, indices move whenever new
+ * nodes get sorted in. A parent has to exist before its children and nodes
+ * cannot be removed or reparented.
+ *
+ * `cgm.h` must be implemented somewhere (`CGM_IMPLEMENTATION`), define
+ * `CGM_THREADS` there to get the parallel update.
+ */
+
+#include "cgm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(TRANSFORM_MALLOC) && !defined(TRANSFORM_FREE) && !defined(TRANSFORM_REALLOC)
+    #include <stdlib.h>
+    #define TRANSFORM_MALLOC malloc
+    #define TRANSFORM_FREE free
+    #define TRANSFORM_REALLOC realloc
+#endif
+#if !defined(TRANSFORM_MALLOC) || !defined(TRANSFORM_FREE) || !defined(TRANSFORM_REALLOC)
+    #error "`transform.h` requires you to define `TRANSFORM_MALLOC()`, `TRANSFORM_FREE()`, `TRANSFORM_REALLOC()` macros"
+#endif
+
+// Levels smaller than this are updated on the calling thread
+#ifndef TRANSFORM_PARALLEL_THRESHOLD
+    #define TRANSFORM_PARALLEL_THRESHOLD 4096
+#endif
+
+typedef uint32_t Transform_Id;
+#define TRANSFORM_NO_PARENT ((uint32_t)-1)
+
+typedef struct {
+    // Per node, indexed by position in depth order
+    size_t count, capacity;
+    Transform_Id* ids;
+    uint32_t* parents;      // index of the parent or TRANSFORM_NO_PARENT
+    uint32_t* depths;
+    V3f* positions;
+    Qf* rotations;
+    V3f* scales;
+    M4f* worlds;
+    uint8_t* dirty;
+    uint32_t* first_children; // children of i are [first_children[i], + child_counts[i])
+    uint32_t* child_counts;
+
+    // Per id
+    uint32_t* indices;
+
+    // Depth d is [level_starts[d], level_starts[d + 1])
+    size_t* level_starts;
+    size_t level_count;
+
+    // Per level, the nodes to visit are [dirty_begins[d], dirty_ends[d])
+    size_t* dirty_begins;
+    size_t* dirty_ends;
+
+    size_t first_dirty_level; // level_count when clean
+    size_t sorted_count;      // nodes past this were added since the last sort
+} Transforms;
+
+void transforms_free(Transforms* t);
+Transform_Id transforms_add(Transforms* t, Transform_Id parent, V3f position, Qf rotation, V3f scale);
+void transforms_set_position(Transforms* t, Transform_Id id, V3f position);
+void transforms_set_rotation(Transforms* t, Transform_Id id, Qf rotation);
+void transforms_set_scale(Transforms* t, Transform_Id id, V3f scale);
+void transforms_update(Transforms* t);
+const M4f* transforms_world(const Transforms* t, Transform_Id id);
+
+#endif // TRANSFORM_H
+
+#ifdef TRANSFORM_IMPLEMENTATION
+
+#include <string.h> // memset
+
+static void transforms__mark_dirty(Transforms* t, uint32_t index)
+{
+    t->dirty[index] = 1;
+    size_t d = t->depths[index];
+    if(d < t->first_dirty_level) t->first_dirty_level = d;
+    // The next update sorts first and visits every level
+    if(t->sorted_count != t->count) return;
+    if(t->dirty_begins[d] >= t->dirty_ends[d]) {
+        t->dirty_begins[d] = index;
+        t->dirty_ends[d] = index + 1;
+    } else {
+        if(index < t->dirty_begins[d]) t->dirty_begins[d] = index;
+        if(index + 1 > t->dirty_ends[d]) t->dirty_ends[d] = index + 1;
+    }
+}
+
+static void transforms__grow(Transforms* t)
+{
+    size_t capacity = t->capacity == 0 ? 64 : t->capacity * 2;
+#define transforms__realloc(field) t->field = TRANSFORM_REALLOC(t->field, capacity * sizeof(*t->field))
+    transforms__realloc(ids);
+    transforms__realloc(parents);
+    transforms__realloc(depths);
+    transforms__realloc(positions);
+    transforms__realloc(rotations);
+    transforms__realloc(scales);
+    transforms__realloc(worlds);
+    transforms__realloc(dirty);
+    transforms__realloc(indices);
+#undef transforms__realloc
+    t->capacity = capacity;
+}
+
+void transforms_free(Transforms* t)
+{
+    TRANSFORM_FREE(t->ids);
+    TRANSFORM_FREE(t->parents);
+    TRANSFORM_FREE(t->depths);
+    TRANSFORM_FREE(t->positions);
+    TRANSFORM_FREE(t->rotations);
+    TRANSFORM_FREE(t->scales);
+    TRANSFORM_FREE(t->worlds);
+    TRANSFORM_FREE(t->dirty);
+    TRANSFORM_FREE(t->first_children);
+    TRANSFORM_FREE(t->child_counts);
+    TRANSFORM_FREE(t->indices);
+    TRANSFORM_FREE(t->level_starts);
+    TRANSFORM_FREE(t->dirty_begins);
+    TRANSFORM_FREE(t->dirty_ends);
+    memset(t, 0, sizeof(*t));
+}
+
+Transform_Id transforms_add(Transforms* t, Transform_Id parent, V3f position, Qf rotation, V3f scale)
+{
+    if(t->count == t->capacity) transforms__grow(t);
+
+    // Appended unsorted, transforms_update() moves it into its level
+    uint32_t index = (uint32_t)t->count++;
+    Transform_Id id = index;
+    uint32_t parent_index = parent == TRANSFORM_NO_PARENT ? TRANSFORM_NO_PARENT : t->indices[parent];
+    t->ids[index] = id;
+    t->indices[id] = index;
+    t->parents[index] = parent_index;
+    t->depths[index] = parent_index == TRANSFORM_NO_PARENT ? 0 : t->depths[parent_index] + 1;
+    t->positions[index] = position;
+    t->rotations[index] = rotation;
+    t->scales[index] = scale;
+    t->dirty[index] = 1;
+    return id;
+}
+
+void transforms_set_position(Transforms* t, Transform_Id id, V3f position)
+{
+    t->positions[t->indices[id]] = position;
+    transforms__mark_dirty(t, t->indices[id]);
+}
+
+void transforms_set_rotation(Transforms* t, Transform_Id id, Qf rotation)
+{
+    t->rotations[t->indices[id]] = rotation;
+    transforms__mark_dirty(t, t->indices[id]);
+}
+
+void transforms_set_scale(Transforms* t, Transform_Id id, V3f scale)
+{
+    t->scales[t->indices[id]] = scale;
+    transforms__mark_dirty(t, t->indices[id]);
+}
+
+const M4f* transforms_world(const Transforms* t, Transform_Id id)
+{
+    return &t->worlds[t->indices[id]];
+}
+
+// Breadth-first order: roots first, then the children of every node in the
+// order of their parents, each node's children in the order they were added
+static void transforms__sort(Transforms* t)
+{
+    size_t count = t->count;
+    uint32_t* child_starts = TRANSFORM_MALLOC((count + 1) * sizeof(*child_starts));
+    memset(child_starts, 0, (count + 1) * sizeof(*child_starts));
+    for(size_t i = 0; i < count; ++i) {
+        if(t->parents[i] != TRANSFORM_NO_PARENT) child_starts[t->parents[i] + 1] += 1;
+    }
+    for(size_t i = 0; i < count; ++i) child_starts[i + 1] += child_starts[i];
+    uint32_t* children = TRANSFORM_MALLOC(count * sizeof(*children));
+    uint32_t* next = TRANSFORM_MALLOC(count * sizeof(*next));
+    memcpy(next, child_starts, count * sizeof(*next));
+    for(size_t i = 0; i < count; ++i) {
+        if(t->parents[i] != TRANSFORM_NO_PARENT) children[next[t->parents[i]]++] = (uint32_t)i;
+    }
+
+    uint32_t* order = next; // new index -> old index
+    t->first_children = TRANSFORM_REALLOC(t->first_children, count * sizeof(*t->first_children));
+    t->child_counts = TRANSFORM_REALLOC(t->child_counts, count * sizeof(*t->child_counts));
+    size_t tail = 0;
+    for(size_t i = 0; i < count; ++i) {
+        if(t->parents[i] == TRANSFORM_NO_PARENT) order[tail++] = (uint32_t)i;
+    }
+    for(size_t head = 0; head < tail; ++head) {
+        uint32_t old = order[head];
+        t->first_children[head] = (uint32_t)tail;
+        t->child_counts[head] = child_starts[old + 1] - child_starts[old];
+        for(uint32_t c = child_starts[old]; c < child_starts[old + 1]; ++c) order[tail++] = children[c];
+    }
+    uint32_t* new_index = children;
+    for(size_t i = 0; i < count; ++i) new_index[order[i]] = (uint32_t)i;
+    TRANSFORM_FREE(order);
+    TRANSFORM_FREE(child_starts);
+
+    size_t level_count = 0;
+    for(size_t i = 0; i < count; ++i) {
+        if(t->depths[i] + 1 > level_count) level_count = t->depths[i] + 1;
+    }
+    TRANSFORM_FREE(t->level_starts);
+    t->level_starts = TRANSFORM_MALLOC((level_count + 1) * sizeof(*t->level_starts));
+    t->level_count = level_count;
+    memset(t->level_starts, 0, (level_count + 1) * sizeof(*t->level_starts));
+    for(size_t i = 0; i < count; ++i) t->level_starts[t->depths[i] + 1] += 1;
+    for(size_t d = 0; d < level_count; ++d) t->level_starts[d + 1] += t->level_starts[d];
+
+#define transforms__permute(field)                                                  \
+    do {                                                                            \
+        void* sorted = TRANSFORM_MALLOC(t->capacity * sizeof(*t->field));           \
+        for(size_t i = 0; i < t->count; ++i) {                                      \
+            memcpy((char*)sorted + new_index[i] * sizeof(*t->field),                \
+                    &t->field[i], sizeof(*t->field));                               \
+        }                                                                           \
+        TRANSFORM_FREE(t->field);                                                   \
+        t->field = sorted;                                                          \
+    } while(0)
+    transforms__permute(ids);
+    transforms__permute(parents);
+    transforms__permute(depths);
+    transforms__permute(positions);
+    transforms__permute(rotations);
+    transforms__permute(scales);
+    transforms__permute(worlds);
+    transforms__permute(dirty);
+#undef transforms__permute
+
+    for(size_t i = 0; i < t->count; ++i) {
+        t->indices[t->ids[i]] = (uint32_t)i;
+        if(t->parents[i] != TRANSFORM_NO_PARENT) t->parents[i] = new_index[t->parents[i]];
+    }
+    TRANSFORM_FREE(new_index);
+
+    // New nodes are anywhere, the first update visits everything
+    t->dirty_begins = TRANSFORM_REALLOC(t->dirty_begins, level_count * sizeof(*t->dirty_begins));
+    t->dirty_ends = TRANSFORM_REALLOC(t->dirty_ends, level_count * sizeof(*t->dirty_ends));
+    memcpy(t->dirty_begins, t->level_starts, level_count * sizeof(*t->dirty_begins));
+    memcpy(t->dirty_ends, t->level_starts + 1, level_count * sizeof(*t->dirty_ends));
+    t->sorted_count = t->count;
+    t->first_dirty_level = 0;
+}
+
+typedef struct {
+    Transforms* t;
+    size_t level_start;
+} Transforms__Job;
+
+static void transforms__update_range(void* user, size_t begin, size_t end)
+{
+    Transforms__Job* job = user;
+    Transforms* t = job->t;
+    for(size_t i = job->level_start + begin; i < job->level_start + end; ++i) {
+        uint32_t parent = t->parents[i];
+        // A recomputed parent leaves its flag set for its own children
+        if(parent != TRANSFORM_NO_PARENT) t->dirty[i] |= t->dirty[parent];
+        if(!t->dirty[i]) continue;
+
+        // scale * rotate * translate, scaling the rotation rows is the same product
+        M4f local = qf_to_m4f(t->rotations[i]);
+        V3f s = t->scales[i];
+        for(int j = 0; j < 3; ++j) {
+            local.elements[0*4 + j] *= s.x;
+            local.elements[1*4 + j] *= s.y;
+            local.elements[2*4 + j] *= s.z;
+        }
+        local.elements[12] = t->positions[i].x;
+        local.elements[13] = t->positions[i].y;
+        local.elements[14] = t->positions[i].z;
+        t->worlds[i] = parent == TRANSFORM_NO_PARENT ? local : m4f_mul_affine(local, t->worlds[parent]);
+    }
+}
+
+void transforms_update(Transforms* t)
+{
+    if(t->sorted_count != t->count) transforms__sort(t);
+    if(t->first_dirty_level >= t->level_count) return;
+
+    size_t above_begin = 0, above_end = 0;
+    for(size_t d = t->first_dirty_level; d < t->level_count; ++d) {
+        // The level's own dirty nodes and everything below a node visited above
+        size_t begin = t->dirty_begins[d], end = t->dirty_ends[d];
+        if(above_begin < above_end) {
+            size_t child_begin = t->first_children[above_begin];
+            size_t child_end = t->first_children[above_end - 1] + t->child_counts[above_end - 1];
+            if(begin >= end) {
+                begin = child_begin;
+                end = child_end;
+            } else if(child_begin < child_end) {
+                if(child_begin < begin) begin = child_begin;
+                if(child_end > end) end = child_end;
+            }
+        }
+        // Kept so the flags can be cleared once the children have read them
+        t->dirty_begins[d] = begin;
+        t->dirty_ends[d] = end;
+        above_begin = begin;
+        above_end = end;
+        if(begin >= end) continue;
+
+        Transforms__Job job = { .t = t, .level_start = begin };
+        cgm_parallel_for(end - begin, TRANSFORM_PARALLEL_THRESHOLD, transforms__update_range, &job);
+    }
+
+    for(size_t d = t->first_dirty_level; d < t->level_count; ++d) {
+        if(t->dirty_begins[d] < t->dirty_ends[d]) memset(t->dirty + t->dirty_begins[d], 0, t->dirty_ends[d] - t->dirty_begins[d]);
+        t->dirty_begins[d] = t->dirty_ends[d] = 0;
+    }
+    t->first_dirty_level = t->level_count;
+}
+
+#endif // TRANSFORM_IMPLEMENTATION